@@ -0,0 +1,57 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file bench_actors.c
+ * \brief ProcessGuards over a full level of standing guards being woken up.
+ * \note Usage: bench_actors [tics]
+ *       The same level and tics as test_sense_replay, run on the calling
+ *       thread only: most guards stand or walk most of the time, so the
+ *       time goes into streaming Guards rather than into tracing. Prints
+ *       the time per tic, the size of entity_t and a hash of the guards.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_level.h"
+#include "../game/wolf_local.h"
+#include "../game/wolf_actors.h"
+#include "../util/timer.h"
+
+
+int main (int argc, char *argv[])
+{
+    int t, numtics = argc > 1 ? atoi (argv[ 1 ]) : 20000;
+    uint64_t start, usec;
+
+    Bench_Level (MAX_GUARDS - 1, false);
+
+    start = Sys_Microseconds();
+
+    for (t = 0 ; t < numtics ; ++t) {
+        Bench_WakeTic (t);
+    }
+
+    usec = Sys_Microseconds() - start;
+
+    printf ("%d guards of %d bytes, %d tics: %.2f usec/tic, hash %08x\n", NumGuards, (int) sizeof (entity_t),
+            numtics, (double) usec / numtics, Bench_GuardHash (0));
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file bench_areas.c
+ * \brief Area connection updates with dozens of doors toggled every tic.
+ * \note Usage: bench_areas [tics]
+ *       64 doors join pairs of areas, most of them neighbours so long
+ *       chains form. Every tic 48 of them open or close the way a door
+ *       does, with Areas_Join or Areas_Disconnect and then Areas_Connect
+ *       for the player's area, and every 7th tic the player moves to
+ *       another area. At the end areabyplayer is checked against a full
+ *       rebuild. Prints the time per tic and a hash of areabyplayer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_level.h"
+#include "../game/wolf_level.h"
+#include "../util/timer.h"
+
+#define BENCH_DOORS     64
+#define BENCH_TOGGLES   48
+
+
+int main (int argc, char *argv[])
+{
+    int t, i, d, numtics = argc > 1 ? atoi (argv[ 1 ]) : 200000;
+    int area1[ BENCH_DOORS ], area2[ BENCH_DOORS ];
+    bool open[ BENCH_DOORS ];
+    bool areas[ NUMAREAS ];
+    int player_area = 0;
+    uint32_t hash = 0;
+    uint64_t start, usec;
+
+    for (d = 0 ; d < BENCH_DOORS ; ++d) {
+        area1[ d ] = Bench_Rnd (NUMAREAS);
+        area2[ d ] = d < 36 ? (area1[ d ] + 1) % NUMAREAS : Bench_Rnd (NUMAREAS);
+        open[ d ] = false;
+    }
+
+    Areas_Init (player_area);
+
+    start = Sys_Microseconds();
+
+    for (t = 0 ; t < numtics ; ++t) {
+        for (i = 0 ; i < BENCH_TOGGLES ; ++i) {
+            d = Bench_Rnd (BENCH_DOORS);
+
+            if (open[ d ]) {
+                Areas_Disconnect (area1[ d ], area2[ d ]);
+            } else {
+                Areas_Join (area1[ d ], area2[ d ]);
+            }
+
+            open[ d ] = ! open[ d ];
+            Areas_Connect (player_area);
+        }
+
+        if (t % 7 == 0) {
+            player_area = Bench_Rnd (NUMAREAS);
+            Areas_Connect (player_area);
+        }
+
+        hash = Bench_Hash (hash, areabyplayer, sizeof (areabyplayer));
+    }
+
+    usec = Sys_Microseconds() - start;
+
+    printf ("%d doors, %d toggles/tic, %d tics: %.3f usec/tic, hash %08x\n", BENCH_DOORS, BENCH_TOGGLES,
+            numtics, (double) usec / numtics, hash);
+
+    memcpy (areas, areabyplayer, sizeof (areas));
+    Areas_Rebuild (player_area);
+
+    if (memcmp (areas, areabyplayer, sizeof (areas))) {
+        printf ("areabyplayer differs from a full rebuild\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file bench_guards.c
+ * \brief ProcessGuards and Door_Process with a full level of chasing guards.
+ * \note Usage: bench_guards [tics]
+ *       Every guard chases the player in god mode, and closed doors are
+ *       opened again every tic, so movement, door and collision checks all
+ *       run at MAX_GUARDS. Prints the time per tic and a hash of the
+ *       guards, which stays the same from run to run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_level.h"
+#include "../game/wolf_local.h"
+#include "../game/wolf_level.h"
+#include "../game/wolf_actors.h"
+#include "../game/wolf_player.h"
+#include "../util/timer.h"
+
+
+int main (int argc, char *argv[])
+{
+    int t, n, numtics = argc > 1 ? atoi (argv[ 1 ]) : 5000;
+    uint64_t start, usec;
+    entity_t *ent;
+
+    Bench_Level (MAX_GUARDS - 1, true);
+
+    for (n = 0 ; n < NumGuards ; ++n) {
+        ent = LIVE_GUARD (n);
+        ent->state = st_chase1;
+        ent->flags |= FL_ATTACKMODE;
+        ent->dir = dir8_nodir;
+    }
+
+    start = Sys_Microseconds();
+
+    for (t = 0 ; t < numtics ; ++t) {
+        memset (&level_los_stats, 0, sizeof (level_los_stats));
+
+        ProcessGuards();
+        Door_Process (&levelData.Doors, 1);
+
+        for (n = 0 ; n < levelData.Doors.doornum ; ++n) {
+            if (levelData.Doors.Doors[ n ].action == dr_closed) {
+                Door_Open (&levelData.Doors.Doors[ n ]);
+            }
+        }
+
+        PL_TryMove (&Player, &levelData);
+        Player.health = 100;
+
+        levelstate.time += tics;
+    }
+
+    usec = Sys_Microseconds() - start;
+
+    printf ("%d guards, %d tics: %.2f usec/tic, hash %08x\n", NumGuards, numtics,
+            (double) usec / numtics, Bench_GuardHash (0));
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file bench_level.c
+ * \brief Synthetic level for the benchmarks and tests.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "bench_level.h"
+#include "../game/wolf_local.h"
+#include "../game/wolf_level.h"
+#include "../game/wolf_actors.h"
+#include "../game/wolf_player.h"
+
+#define BENCH_HASH_SEED     2166136261u
+
+static uint32_t bench_seed;
+
+
+/**
+ * \brief Random numbers for placing things, kept apart from the game's own.
+ * \param[in] range Upper bound.
+ * \return Random number between 0 and range - 1.
+ */
+int Bench_Rnd (int range)
+{
+    bench_seed = bench_seed * 1664525 + 1013904223;
+
+    return (int) ((bench_seed >> 8) % range);
+}
+
+/**
+ * \brief FNV-1a hash of some bytes.
+ * \param[in] hash Hash so far, 0 to start.
+ * \param[in] data Bytes to add.
+ * \param[in] size Number of bytes.
+ * \return New hash.
+ */
+uint32_t Bench_Hash (uint32_t hash, const void *data, size_t size)
+{
+    const uint8_t *p = data;
+
+    if (! hash) {
+        hash = BENCH_HASH_SEED;
+    }
+
+    while (size--) {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Hash the live guards, hot and cold parts, in list order.
+ * \param[in] hash Hash so far, 0 to start.
+ * \return New hash.
+ */
+uint32_t Bench_GuardHash (uint32_t hash)
+{
+    int n;
+
+    for (n = 0 ; n < NumGuards ; ++n) {
+        hash = Bench_Hash (hash, LIVE_GUARD (n), sizeof (entity_t));
+        hash = Bench_Hash (hash, ACTOR_COLD (LIVE_GUARD (n)), sizeof (entity_cold_t));
+    }
+
+    return Bench_Hash (hash, &NumGuards, sizeof (NumGuards));
+}
+
+/**
+ * \brief Build the level and spawn the guards.
+ * \param[in] guards Number of guards, at most MAX_GUARDS - 1.
+ * \param[in] patrol true to spawn them patrolling, otherwise standing.
+ */
+void Bench_Level (int guards, bool patrol)
+{
+    int x, y, n;
+
+    bench_seed = 1;
+
+    memset (&levelstate, 0, sizeof (levelstate));
+    WM_BuildTables();
+    US_InitRndT (false);
+
+    r_world = &levelData;
+    memset (&levelData, 0, sizeof (levelData));
+
+    ResetGuards();
+    Sprite_Reset();
+    PushWall_Reset();
+
+    for (x = 0 ; x < 64 ; ++x) {
+        for (y = 0 ; y < 64 ; ++y) {
+            if (! x || ! y || x == 63 || y == 63 ||
+                    (x % 8 == 0 && y % 8 != 4) || (x % 13 == 5 && y % 7 == 3)) {
+                levelData.tilemap[ x ][ y ] = WALL_TILE;
+                levelData.areas[ x ][ y ] = -1;
+            }
+        }
+    }
+
+    // a door in the middle of every room's east and west wall
+    for (x = 8 ; x < 64 ; x += 8) {
+        for (y = 4 ; y < 64 ; y += 8) {
+            levelData.tilemap[ x ][ y ] = DOOR_TILE;
+            levelData.areas[ x ][ y ] = -1;
+            Door_Spawn (&levelData.Doors, x, y, 0x5A);
+        }
+    }
+
+    Door_SetAreas (&levelData.Doors, levelData.areas);
+
+    memset (&Player, 0, sizeof (Player));
+    Player.position.origin[ 0 ] = TILE2POS (30);
+    Player.position.origin[ 1 ] = TILE2POS (30);
+    Player.health = 100;
+    Player.flags |= FL_GODMODE;
+    Player.playstate = ex_playing;
+
+    Areas_Init (0);
+    Level_LOSReset (&levelData);
+
+    skill = 1;
+    tics = 1;
+
+    for (n = 0 ; n < guards ; ++n) {
+        do {
+            x = 1 + Bench_Rnd (62);
+            y = 1 + Bench_Rnd (62);
+        } while (levelData.tilemap[ x ][ y ] & (WALL_TILE | DOOR_TILE | ACTOR_TILE));
+
+        if (patrol) {
+            SpawnPatrol (en_guard, x, y, Bench_Rnd (4));
+        } else {
+            SpawnStand (en_guard, x, y, Bench_Rnd (4));
+        }
+
+        levelData.tilemap[ x ][ y ] |= ACTOR_TILE;
+    }
+}
+
+/**
+ * \brief Run one tic of standing guards being woken up.
+ * \param[in] tic Tic number, from 0.
+ * \note The player walks up and down the middle of the level and makes a
+ *       noise every 200 tics, so guards keep waking up, looking and
+ *       chasing, then lose track again.
+ */
+void Bench_WakeTic (int tic)
+{
+    memset (&level_los_stats, 0, sizeof (level_los_stats));
+
+    Player.position.origin[ 1 ] = TILE2POS (30) + ((tic / 4) % 64 - 32) * 0x1000;
+    Player.madenoise = (tic % 200 == 100);
+
+    ProcessGuards();
+    Player.madenoise = false;
+    Door_Process (&levelData.Doors, 1);
+    Player.health = 100;
+
+    levelstate.time += tics;
+}
@@ -0,0 +1,49 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+ *  bench_level.h:   Synthetic level for the benchmarks and tests.
+ *
+ */
+
+/*
+    Notes:
+    This module is implemented by bench_level.c
+
+    The benchmarks and tests in this directory run the game logic on a
+    level built in code, so they need no data files, window or sound.
+    The level is 64x64 tiles of 8x8 rooms joined by doors, with pillars
+    here and there, and the player standing in god mode in the middle.
+    Everything is placed from a fixed seed, so every run is the same.
+
+*/
+
+#ifndef __BENCH_LEVEL_H__
+#define __BENCH_LEVEL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void Bench_Level (int guards, bool patrol);
+int Bench_Rnd (int range);
+uint32_t Bench_Hash (uint32_t hash, const void *data, size_t size);
+uint32_t Bench_GuardHash (uint32_t hash);
+void Bench_WakeTic (int tic);
+
+
+#endif /* __BENCH_LEVEL_H__ */
@@ -0,0 +1,141 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file bench_math.c
+ * \brief Fixed point FINE angle trig against libm floats.
+ * \note Usage: bench_math [calls]
+ *       Times FixedSin, FixedCos, FineAtan2, Point2LineDist and
+ *       TransformPoint next to the float code they replaced, and prints
+ *       nanoseconds per call.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../game/wolf_math.h"
+#include "../util/timer.h"
+
+
+// points spread over a level, wrapped so they never overflow
+#define BENCH_X( i )    (((i) & 0xffff) * 977)
+#define BENCH_Y( i )    (-((i) & 0x3fff) * 131)
+
+volatile unsigned bench_sink;  // keeps the loops from being optimised away
+
+// Point2LineDist before FINE angles, angle in radians
+static int Float_Point2LineDist (const int x, const int y, const float angle)
+{
+    return ABS ((int) (x * sin (angle) - y * cos (angle)));
+}
+
+// TransformPoint before FINE angles, returns radians
+static float Float_TransformPoint (const double x1, const double y1, const double x2, const double y2)
+{
+    return angle_normalize ((float) atan2 (y1 - y2, x1 - x2));
+}
+
+static void Bench_Report (const char *name, int calls, uint64_t usec)
+{
+    printf ("%-22s %6.2f nsec\n", name, (double) usec * 1000.0 / calls);
+}
+
+int main (int argc, char *argv[])
+{
+    unsigned acc = 0;
+    int i, calls = argc > 1 ? atoi (argv[ 1 ]) : 20000000;
+    uint64_t start;
+
+    WM_BuildTables();
+
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += FixedSin (i * 7);
+    }
+
+    Bench_Report ("FixedSin", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += (int) (sin (FINE2RAD (i * 7 % ANG_360)) * FIXED_ONE);
+    }
+
+    Bench_Report ("sin", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += FixedCos (i * 7);
+    }
+
+    Bench_Report ("FixedCos", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += (int) (cos (FINE2RAD (i * 7 % ANG_360)) * FIXED_ONE);
+    }
+
+    Bench_Report ("cos", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += FineAtan2 (BENCH_X (i), BENCH_Y (i));
+    }
+
+    Bench_Report ("FineAtan2", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += (int) RAD2FINE (atan2 (BENCH_X (i), BENCH_Y (i)));
+    }
+
+    Bench_Report ("atan2", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += Point2LineDist (BENCH_X (i), BENCH_Y (i), i % ANG_360);
+    }
+
+    Bench_Report ("Point2LineDist", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += Float_Point2LineDist (BENCH_X (i), BENCH_Y (i), (float) FINE2RAD (i % ANG_360));
+    }
+
+    Bench_Report ("Point2LineDist float", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += TransformPoint (BENCH_X (i), BENCH_Y (i), 5, 7);
+    }
+
+    Bench_Report ("TransformPoint", calls, Sys_Microseconds() - start);
+    start = Sys_Microseconds();
+
+    for (i = 0 ; i < calls ; ++i) {
+        acc += (int) (1000 * Float_TransformPoint (BENCH_X (i), BENCH_Y (i), 5, 7));
+    }
+
+    Bench_Report ("TransformPoint float", calls, Sys_Microseconds() - start);
+
+    bench_sink = acc;
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file test_math.c
+ * \brief The game's fixed point math gives the same results on every build.
+ * \note Hashes the trig tables, the direction helpers, FineAtan2, both
+ *       projections, FixedMul and the random number table over a fixed
+ *       set of inputs, and compares the hash with the one below. The
+ *       build compiles this test once per optimisation level, so a
+ *       compiler or flag that changes game math fails it. Also checks
+ *       the tables are still close to libm. Exits 1 on a mismatch.
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "../game/wolf_local.h"
+#include "../game/wolf_math.h"
+
+#define TEST_MATH_HASH  0x182a41e6u     // expected hash, the same on every build
+
+level_locals_t levelstate;  // US_RndT keeps its place here, normally game.c's
+
+
+static uint32_t Test_Hash (uint32_t hash, int value)
+{
+    return (hash ^ (uint32_t) value) * 16777619u;
+}
+
+int main (void)
+{
+    uint32_t hash = 2166136261u, seed = 12345;
+    double err, max_sin = 0, max_atan = 0;
+    int i, dx, dy, angle, fine;
+
+    WM_BuildTables();
+    US_InitRndT (false);
+
+    for (i = -ANG_360 ; i < 2 * ANG_360 ; i += 7) {
+        hash = Test_Hash (hash, FixedSin (i));
+        hash = Test_Hash (hash, FixedCos (i));
+        hash = Test_Hash (hash, Get8dir (i));
+        hash = Test_Hash (hash, Get4dir (i));
+        hash = Test_Hash (hash, FineNormalize (i));
+        hash = Test_Hash (hash, FineDiff (i, ANG_90));
+
+        err = fabs (FixedSin (i) / (double) FIXED_ONE - sin (FINE2RAD (i)));
+
+        if (err > max_sin) {
+            max_sin = err;
+        }
+    }
+
+    for (i = 0 ; i < 200000 ; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        dx = (int) ((seed >> 8) % (64 << 16)) - (32 << 16);
+        seed = seed * 1103515245u + 12345u;
+        dy = (int) ((seed >> 8) % (64 << 16)) - (32 << 16);
+        angle = (int) ((seed >> 4) % ANG_360);
+
+        fine = FineAtan2 (dy, dx);
+
+        hash = Test_Hash (hash, fine);
+        hash = Test_Hash (hash, Point2LineDist (dx, dy, angle));
+        hash = Test_Hash (hash, LineLen2Point (dx, dy, angle));
+        hash = Test_Hash (hash, TransformPoint (dx, dy, dy >> 3, dx >> 3));
+        hash = Test_Hash (hash, FixedMul (dx, FixedCos (angle)));
+
+        if (dx || dy) {
+            err = RAD2FINE (atan2 (dy, dx));
+            err = fabs (fine - (err < 0 ? err + ANG_360 : err));
+
+            if (err > ANG_180) {
+                err = ANG_360 - err;
+            }
+
+            if (err > max_atan) {
+                max_atan = err;
+            }
+        }
+    }
+
+    for (i = 0 ; i < 1024 ; ++i) {
+        hash = Test_Hash (hash, US_RndT());
+    }
+
+    printf ("hash %08x, max sin error %.2e, max atan2 error %.2f FINE units\n", hash, max_sin, max_atan);
+
+    if (hash != TEST_MATH_HASH) {
+        printf ("expected hash %08x\n", TEST_MATH_HASH);
+        return 1;
+    }
+
+    if (max_sin > 1e-5 || max_atan > 2) {
+        printf ("the tables drifted from libm\n");
+        return 1;
+    }
+
+    return 0;
+}
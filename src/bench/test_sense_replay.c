@@ -0,0 +1,140 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file test_sense_replay.c
+ * \brief The sense phase gives the same game with and without worker threads.
+ * \note Usage: test_sense_replay [tics]
+ *       Replays the same level twice, once with every sight line traced
+ *       on the calling thread and once on JOBS_MAX_THREADS workers. Each
+ *       replay runs in its own forked process, so nothing the first one
+ *       left behind can steer the second. The player walks up and down and
+ *       makes a noise now and then, so guards keep waking up and looking.
+ *       The guards are hashed every tic, and the two runs have to end with
+ *       the same hash. Exits 1 if they don't, or if no tic ever had enough
+ *       lines to hand to the workers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "bench_level.h"
+#include "../game/wolf_local.h"
+#include "../game/wolf_level.h"
+#include "../game/wolf_actors.h"
+#include "../util/jobs.h"
+
+typedef struct {
+    uint32_t hash;          // of the guards over every tic
+    uint32_t maxsensed;     // most lines traced ahead in one tic
+
+} replay_t;
+
+
+/**
+ * \brief Run the level for a number of tics.
+ * \param[in] numthreads Worker threads for the sight lines.
+ * \param[in] numtics Tics to run.
+ * \param[out] result Hash and most lines in a tic.
+ */
+static void Replay (int numthreads, int numtics, replay_t *result)
+{
+    int t;
+
+    Jobs_Init (numthreads);
+    Bench_Level (MAX_GUARDS - 1, false);
+
+    result->hash = 0;
+    result->maxsensed = 0;
+
+    for (t = 0 ; t < numtics ; ++t) {
+        Bench_WakeTic (t);
+
+        if (level_los_stats.sensed > result->maxsensed) {
+            result->maxsensed = level_los_stats.sensed;
+        }
+
+        result->hash = Bench_GuardHash (result->hash);
+    }
+
+    printf ("%d threads, %d guards, %d tics: most lines in a tic %u, hash %08x\n",
+            Jobs_NumThreads(), NumGuards, numtics, result->maxsensed, result->hash);
+
+    Jobs_Shutdown();
+}
+
+/**
+ * \brief Run Replay in a fresh process.
+ * \return true if the replay ran and result was filled in.
+ */
+static bool Replay_Fork (int numthreads, int numtics, replay_t *result)
+{
+    int fds[ 2 ], status;
+    bool ok;
+    pid_t pid;
+
+    if (pipe (fds) != 0) {
+        printf ("[Replay_Fork]: pipe failed\n");
+        return false;
+    }
+
+    fflush (stdout);
+    pid = fork();
+
+    if (pid < 0) {
+        printf ("[Replay_Fork]: fork failed\n");
+        return false;
+    }
+
+    if (pid == 0) {
+        close (fds[ 0 ]);
+        Replay (numthreads, numtics, result);
+        fflush (stdout);
+        _exit (write (fds[ 1 ], result, sizeof (*result)) == sizeof (*result) ? 0 : 1);
+    }
+
+    close (fds[ 1 ]);
+    ok = read (fds[ 0 ], result, sizeof (*result)) == sizeof (*result);
+    close (fds[ 0 ]);
+
+    return waitpid (pid, &status, 0) == pid && WIFEXITED (status) && WEXITSTATUS (status) == 0 && ok;
+}
+
+int main (int argc, char *argv[])
+{
+    int numtics = argc > 1 ? atoi (argv[ 1 ]) : 3001;
+    replay_t serial, threaded;
+
+    if (! Replay_Fork (0, numtics, &serial) || ! Replay_Fork (JOBS_MAX_THREADS, numtics, &threaded)) {
+        return 1;
+    }
+
+    if (threaded.maxsensed <= JOBS_BATCH) {
+        printf ("the worker threads were never used\n");
+        return 1;
+    }
+
+    if (serial.hash != threaded.hash) {
+        printf ("threaded run differs from the serial run\n");
+        return 1;
+    }
+
+    return 0;
+}
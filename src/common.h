@@ -42,6 +42,7 @@
 
 void Client_Init (void);
 void frame_run(int msec);
+void frame_think(void);
 
 
 typedef enum { FONT0 = 0, FONT1, FONT2, FONT3 } FONTSELECT;
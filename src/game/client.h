@@ -99,12 +99,15 @@ typedef struct {
     float   frametime;          // seconds since last frame
 
     float   disable_screen;    // showing loading plaque between levels
+
+    bool    headless;          // no window, GL or audio, see Headless_Run
 } client_static_t;
 
 extern client_static_t  ClientStatic;
 
 void Client_Init (void);
 void Client_Screen_UpdateScreen (void);
+int Client_LatchViewAngle (void);
 
 void Menu_Init (void);
 void M_Draw (void);
@@ -31,15 +31,22 @@
 #include "../graphics/video.h"
 #include "../graphics/renderer.h"
 #include "../util/timer.h"
+#include "../util/arena.h"
 
 #include "wolf_local.h"
 #include "wolf_level.h"
 #include "wolf_player.h"
+#include "wolf_snapshot.h"
+#include "wolf_demo.h"
+#include "../sound/music.h"
+#include "../sound/soundfx.h"
 #include "../graphics/wolf_renderer.h"
+#include "../graphics/stats_overlay.h"
 #include "wolf_menu.h"
 
 
 #include "../graphics/opengl_local.h"
+#include "../input/input.h"
 #include "menu/intro.h"
 
 float sensitivity;
@@ -100,12 +107,27 @@ void Client_Screen_UpdateScreen (void)
     R_BeginFrame();
     V_RenderView(); // Draw game world
     M_Draw(); // Draw menu
+    stats_overlay_draw();
     R_EndFrame();
+    stats_latency_end();
+}
+
+/**
+ * \brief Show loading progress.
+ * \param[in] percent How far loading is.
+ */
+static void Client_Psyched (int percent)
+{
+    if (! ClientStatic.headless) {
+        R_DrawPsyched (percent);
+        R_EndFrame();
+    }
 }
 
 /**
  * \brief Refresh level
  * \param[in] r_mapname Name of name
+ * \note Headless, only what the simulation needs is loaded.
  */
 void Client_PrepRefresh (const char *r_mapname)
 {
@@ -115,8 +137,7 @@ void Client_PrepRefresh (const char *r_mapname)
         return;
     }
 
-    R_DrawPsyched (0);
-    R_EndFrame();
+    Client_Psyched (0);
 
     spritelocation = WL6SPRITESDIRNAME;
 
@@ -137,29 +158,32 @@ void Client_PrepRefresh (const char *r_mapname)
         return;
     }
 
-    R_DrawPsyched (30);
-    R_EndFrame();
+    US_InitRndT (! Demo_Active() && ! ClientStatic.headless);   // demos and headless runs repeat
+
+    Client_Psyched (30);
 
     Level_ScanInfoPlane (r_world);  // Spawn items/guards
+    Snap_KeepPristine (r_world);    // snapshots store what changes from here
 
     PL_Spawn (r_world->pSpawn, r_world);  // Spawn Player
 
-    Level_PrecacheTextures_Sound (r_world);
+    if (! ClientStatic.headless) {
+        Level_PrecacheTextures_Sound (r_world);
 
-    R_DrawPsyched (80);
-    R_EndFrame();
+        R_DrawPsyched (80);
+        R_EndFrame();
 
-    // the renderer can now free unneeded stuff
-    R_EndRegistration();
+        // the renderer can now free unneeded stuff
+        R_EndRegistration();
 
-    R_DrawPsyched (100);
-    R_EndFrame();
+        R_DrawPsyched (100);
+        R_EndFrame();
 
-    if (r_world->musicName) {
-        //Sound_StartBGTrack (r_world->musicName, r_world->musicName);
-    }
+        // prefetched during the intermission, if there was one
+        music_play (r_world->musicName);
 
-    R_EndFrame();
+        R_EndFrame();
+    }
 
     // FIXME moved from wolf_sv_ccmds.c - Map_f()
     if (r_world) {
@@ -174,17 +198,79 @@ int tics;
 
 extern void DrawMenus();
 
+/**
+ * \brief Run the simulation for one tic on the input in ClientState.
+ * \note Shared by frame_run and the headless mode, which renders nothing.
+ */
+void frame_think(void)
+{
+    uint64_t think_start;
+
+    memset (&level_los_stats, 0, sizeof (level_los_stats));
+    PL_Process (&Player, r_world);   // Player processing
+    PL_UpdateFace (&Player);
+    Sound_SetListener (Player.position.origin[ 0 ], Player.position.origin[ 1 ], Player.position.angle);
+
+    think_start = Sys_Microseconds();
+    ProcessGuards();                // if single
+    PushWall_Process();
+    Door_Process (&r_world->Doors, tics);
+    stats_think_usec = (uint32_t) (Sys_Microseconds() - think_start);
+
+    levelstate.time += tics;
+}
+
+/**
+ * \brief Can the player turn and move?
+ */
+static bool Client_CanMove (void)
+{
+    return Player.playstate != ex_dead &&
+           Player.playstate != ex_watchingdeathcam &&
+           Player.playstate != ex_watchingbj;
+}
+
+/**
+ * \brief Turn the view by the mouse motion since the last call.
+ */
+static void Client_MouseLook (void)
+{
+    int dx = input_mouse_take();
+
+    // a tenth of a degree per count at the default sensitivity of 50
+    ClientState.viewangles[ YAW ] -= dx * sensitivity * m_yaw * ANG_1 / 500;
+}
+
+/**
+ * \brief Latch the newest view angle, just before the 3D view is drawn.
+ * \return Angle to draw the view at.
+ * \note Mouse motion since the tic started turns the view now; the
+ *       simulation picks the angle up with the next tic.
+ */
+int Client_LatchViewAngle (void)
+{
+    if (! Client_CanMove() || Demo_Playing()) {
+        return Player.position.angle;
+    }
+
+    input_poll();
+    Client_MouseLook();
+
+    return FineNormalize ((int) ClientState.viewangles[ YAW ]);
+}
+
 static void frame_run_game()
 {
-    if (Player.playstate != ex_dead &&
-        Player.playstate != ex_watchingdeathcam &&
-        Player.playstate != ex_watchingbj)
+    if (Client_CanMove())
     {
+        Client_MouseLook();
         player_update_movement();
+        Demo_Tic();
 
-        Player.position.angle = angle_normalize (FINE2RAD (ClientState.viewangles[ YAW ]));
+        Player.position.angle = FineNormalize ((int) ClientState.viewangles[ YAW ]);
     } else {
         memset (&ClientState.cmd, 0, sizeof (ClientState.cmd));
+        Demo_Tic();
     }
 
     if ((Player.playstate == ex_complete || Player.playstate == ex_secretlevel)) {
@@ -192,12 +278,8 @@ static void frame_run_game()
             M_Intermission_f();
         }
     } else {
-        PL_Process (&Player, r_world);   // Player processing
-        ProcessGuards();                // if single
-        PushWall_Process();
-        Door_Process (&r_world->Doors, tics);
-
-        levelstate.time += tics;
+        frame_think();
+        Snap_Frame();
     }
 }
 
@@ -237,6 +319,11 @@ void frame_run(int msec)
     static int extratime;
     extratime += msec;
 
+    // input polled from here on belongs to the next tic
+    input_dispatch(Sys_Microseconds());
+
+    Mem_BeginFrame();
+
     // decide the simulation time
     ClientStatic.frametime = extratime / 1000.0f;
     ClientStatic.realtime  = Sys_Milliseconds();
@@ -260,6 +347,8 @@ void frame_run(int msec)
             break;
     }
 
+    input_mouse_take(); // motion while the player cannot turn is dropped
+
     Client_Screen_UpdateScreen();
     ClientStatic.framecount++;
 }
\ No newline at end of file
@@ -27,11 +27,16 @@
 #include <assert.h>
 #include <string.h>
 
+#include <SDL2/SDL.h>
+#include <zlib.h>
+
 #include "wolf_local.h"
 #include "wolf_powerups.h"
 #include "wolf_sprites.h"
 #include "wolf_player.h"
 #include "wolf_act_stat.h"
+#include "wolf_raycast.h"
+#include "wolf_snapshot.h"
 
 #include "../util/com_string.h"
 #include "client.h"
@@ -82,82 +87,149 @@ void Game_Init (void)
 }
 
 //FIXME: put this in the right place
-#define SAVEGAME_VERSION 0
+#define SAVEGAME_VERSION    9
+#define SAVEGAME_MAGIC      0x56415357  // "WSAV"
+
+extern void StartGame (int episode, int mission, int g_skill);
+
+/*
+    Save game layout: a saveheader_t, then a snapshot compressed with zlib,
+    see wolf_snapshot.c.
+*/
+typedef struct {
+    uint32_t magic;
+    int32_t version;
+    uint32_t level_crc; // Snap_LevelCrc, the level delta applies to that level only
+    uint32_t size;      // snapshot bytes
+    uint32_t packed;    // snapshot bytes in the file, after the header
+
+} saveheader_t;
+
+// owned by the save thread while it runs
+static uint8_t save_raw[ SNAP_MAX_SIZE ];
+static uint8_t save_packed[ SNAP_MAX_SIZE + SNAP_MAX_SIZE / 1000 + 64 ];
+static saveheader_t save_header;
+static char save_path[ 1024 ];
+static char save_tmppath[ 1024 ];
+static SDL_Thread *save_thread;
 
-extern uint8_t areaconnect[ NUMAREAS ][ NUMAREAS ];
-extern bool areabyplayer[ NUMAREAS ];
+/**
+ * \brief Wait until the save game being written is on disk.
+ */
+static void Save_Wait (void)
+{
+    if (save_thread) {
+        SDL_WaitThread (save_thread, NULL);
+        save_thread = NULL;
+    }
+}
+
+/**
+ * \brief Compress the snapshot and write the save game.
+ * \return 1 on success, otherwise 0
+ * \note Runs on its own thread. Writes a temporary file first so an
+ *       unfinished save never replaces a good one.
+ */
+static int Save_Write (void *unused)
+{
+    FILE *f;
+    uLongf packed = sizeof (save_packed);
+    bool ok;
+
+    (void) unused;
+
+    if (compress2 (save_packed, &packed, save_raw, save_header.size, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        printf ("[Save_Write]: could not compress %s\n", save_path);
+        return 0;
+    }
+
+    save_header.packed = (uint32_t) packed;
+
+    f = fopen (save_tmppath, "wb");
+
+    if (! f) {
+        printf ("[Save_Write]: could not open %s\n", save_tmppath);
+        return 0;
+    }
+
+    ok = fwrite (&save_header, sizeof (save_header), 1, f) == 1 &&
+         fwrite (save_packed, packed, 1, f) == 1;
+
+    if (fclose (f) != 0 || ! ok) {
+        printf ("[Save_Write]: could not write %s\n", save_tmppath);
+        remove (save_tmppath);
+        return 0;
+    }
+
+    if (rename (save_tmppath, save_path) != 0) {
+        remove (save_path); // rename doesn't replace files everywhere
+
+        if (rename (save_tmppath, save_path) != 0) {
+            printf ("[Save_Write]: could not rename %s\n", save_tmppath);
+            return 0;
+        }
+    }
+
+    return 1;
+}
 
 /**
  * Save current game state to file
  * @param[in] name Name of save game file.
+ * @note Only the snapshot is taken here, compressing and writing happen on a thread.
  */
 void SaveTheGame (const char *name)
 {
-    FILE    *f;
-    char    path[1024];
-    int     version = SAVEGAME_VERSION;
-    int     i;
-    LevelData_t copiedLevelData;
+    static bool wait_at_exit;
 
     if (Player.playstate != ex_playing) {
         return;
     }
 
-    com_snprintf (path, sizeof (path), "%s%c%s.bin", FS_Userdir(), PATH_SEP, name);
-    f = fopen (path, "wb");
+    Save_Wait();    // the buffers still belong to the last save
 
-    if (! f) {
+    currentMap.version = SAVEGAME_VERSION;
+
+    save_header.magic = SAVEGAME_MAGIC;
+    save_header.version = SAVEGAME_VERSION;
+    save_header.level_crc = Snap_LevelCrc();
+    save_header.size = (uint32_t) Snap_Capture (save_raw);
+    save_header.packed = 0;
+
+    if (! save_header.size) {
         return;
     }
 
-    // turn the r_world->Doors.doors from pointers to indexes
-    // Can't be destructive anymore, because the app can be suspended in the background now.
-
-    // Quick fix for non-destructiveness: Just make a copy of the levelData, convert the
-    // pointers to indices in the copy, and write the copy to the save data. Leave the actual
-    // current levelData alone.
-    copiedLevelData = levelData;
+    com_snprintf (save_path, sizeof (save_path), "%s%c%s.bin", FS_Userdir(), PATH_SEP, name);
+    com_snprintf (save_tmppath, sizeof (save_tmppath), "%s.tmp", save_path);
 
-    for (i = 0 ; i < copiedLevelData.Doors.doornum ; i++) {
-        intptr_t index = r_world->Doors.Doors[i] - &r_world->Doors.DoorMap[0][0];
-        assert (index >= 0 && index < 4096);
-        copiedLevelData.Doors.Doors[i] = (void *)index;
+    if (! wait_at_exit) {
+        atexit (Save_Wait);
+        wait_at_exit = true;
     }
 
-    // this is only used for the mutant death face, so just
-    // clear it instead of fixing it up
-    Player.LastAttacker = NULL;
+    save_thread = SDL_CreateThread (Save_Write, "save", NULL);
 
-    currentMap.version = SAVEGAME_VERSION;
-    fwrite (&currentMap, 1, sizeof (currentMap), f);
-
-    fwrite (&copiedLevelData, 1, sizeof (levelData), f);
-    fwrite (&LevelRatios, 1, sizeof (LevelRatios), f);
-    fwrite (&levelstate, 1, sizeof (levelstate), f);
-    fwrite (Guards, 1, sizeof (Guards), f);
-    fwrite (areaconnect, 1, sizeof (areaconnect), f);
-    fwrite (areabyplayer, 1, sizeof (areabyplayer), f);
-    fwrite (&PWall, 1, sizeof (PWall), f);
-    fwrite (&Player, 1, sizeof (Player), f);
-    fwrite (&version, 1, sizeof (version), f);
-
-    fclose (f);
+    if (! save_thread) {
+        Save_Write (NULL);
+    }
 }
 
-extern void StartGame (int episode, int mission, int g_skill);
-
 /**
  * Load game state from file
  * @param[in] name Name of save game file to load.
  * @return 1 on success, otherwise 0
+ * @note If the saved map is the one being played, it is not loaded again.
  */
 int LoadTheGame (const char *name)
 {
     FILE    *f;
     char    path[1024];
-    int     version;
-    int     i;
-    int     oldCompleted;
+    saveheader_t header;
+    currentMap_t map;
+    uLongf size;
+
+    Save_Wait();    // it may be writing this very file
 
     com_snprintf (path, sizeof (path), "%s%c%s.bin", FS_Userdir(), PATH_SEP, name);
     f = fopen (path, "rb");
@@ -166,46 +238,45 @@ int LoadTheGame (const char *name)
         return 0;
     }
 
-    fread (&currentMap, 1, sizeof (currentMap) , f);
-
-    if (currentMap.version != SAVEGAME_VERSION) {
+    if (fread (&header, sizeof (header), 1, f) != 1 ||
+            header.magic != SAVEGAME_MAGIC || header.version != SAVEGAME_VERSION ||
+            header.size > sizeof (save_raw) || header.packed > sizeof (save_packed) ||
+            fread (save_packed, header.packed, 1, f) != 1) {
         fclose (f);
         return 0;
     }
 
-    // do a normal map start
-    skill = currentMap.skill;
-    PL_NewGame (&Player);
-
-    oldCompleted = currentMap.levelCompleted;
-    StartGame (currentMap.episode, currentMap.map, currentMap.skill);
+    fclose (f);
 
-    currentMap.levelCompleted = oldCompleted;
+    size = header.size;
 
-    // load modifications on top
-    fread (&levelData, 1, sizeof (levelData), f);
-    fread (&LevelRatios, 1, sizeof (LRstruct), f);
-    fread (&levelstate, 1, sizeof (levelstate), f);
-    fread (Guards, 1, sizeof (Guards), f);
-    fread (areaconnect, 1, sizeof (areaconnect), f);
-    fread (areabyplayer, 1, sizeof (areabyplayer), f);
-    fread (&PWall, 1, sizeof (PWall), f);
-    fread (&Player, 1, sizeof (Player), f);
-    fread (&version, 1, sizeof (version), f);
-
-    fclose (f);
+    if (uncompress (save_raw, &size, save_packed, header.packed) != Z_OK || size != header.size ||
+            ! Snap_PeekMap (save_raw, size, &map) || map.version != SAVEGAME_VERSION) {
+        printf ("[LoadTheGame]: %s is damaged\n", path);
+        return 0;
+    }
 
-    ClientState.viewangles[ YAW ] = RAD2FINE (Player.position.angle);
+    if (Snap_LevelReady (&map)) {
+        // the map is up already, don't load and precache it again
+        M_ForceMenuOff();
+        ClientStatic.menuState = IPM_GAME;
+        ClientStatic.key_dest = key_game;
+    } else {
+        // do a normal map start
+        skill = map.skill;
+        PL_NewGame (&Player);
+        StartGame (map.episode, map.map, map.skill);
+    }
 
-    if (version != SAVEGAME_VERSION) {
+    if (header.level_crc != Snap_LevelCrc()) {
+        printf ("[LoadTheGame]: %s was saved on a different map\n", path);
         return 0;
     }
 
-    // turn the r_world->Doors.doors back to pointers
-    for (i = 0 ; i < r_world->Doors.doornum ; i++) {
-        int index = (intptr_t)r_world->Doors.Doors[i];
-        assert (index >= 0 && index < 4096);
-        r_world->Doors.Doors[i] = &r_world->Doors.DoorMap[0][0] + index;
+    // load modifications on top
+    if (! Snap_Restore (save_raw, size)) {
+        printf ("[LoadTheGame]: %s is damaged\n", path);
+        return 0;
     }
 
     return 1;
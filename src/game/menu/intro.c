@@ -40,6 +40,7 @@
 #include "../graphics/renderer.h"
 #include "../util/com_string.h"
 #include "../../input/input.h"
+#include "../../sound/music.h"
 
 static uint8_t  intro_slide = 0;
 static uint32_t intro_basetime;
@@ -146,7 +147,7 @@ void intro_next_slide()
 
 void intro_init()
 {
-    // Sound_StartBGTrack ("music/INTROCW3.ogg", "music/INTROCW3.ogg");
+    music_play("music/INTROCW3.ogg");
 
     intro_slide = 0;
 
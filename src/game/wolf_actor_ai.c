@@ -39,6 +39,7 @@
 
 #include "client.h"
 #include "../graphics/opengl_local.h"
+#include "../sound/soundfx.h"
 
 const char dsounds[ 7 ][ 32 ] = {
     "sfx/025.wav",
@@ -69,43 +70,43 @@ void A_DeathScream (entity_t *entity)
 {
     switch (entity->type) {
     case en_mutant:
-          //  Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/037.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/037.wav"));
         break;
     case en_guard:
-         //   Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound (dsounds[ US_RndT() % 6 ]), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound (dsounds[ US_RndT() % 6 ]));
         break;
     case en_officer:
-          //  Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/074.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/074.wav"));
         break;
     case en_ss:
-          //  Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/046.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/046.wav"));
         break;
     case en_dog:
-           // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/035.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/035.wav"));
         break;
     case en_boss:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/019.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/019.wav"));
         break;
     case en_schabbs:
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/061.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/061.wav"));
         break;
     case en_fake:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/069.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/069.wav"));
         break;
     case en_mecha:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/084.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/084.wav"));
         break;
     case en_hitler:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/044.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/044.wav"));
         break;
     case en_gretel:
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/115.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/115.wav"));
         break;
     case en_gift:
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/091.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/091.wav"));
         break;
     case en_fat:
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/119.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (entity, CHAN_VOICE, Sound_RegisterSound ("sfx/119.wav"));
         break;
     }
 }
@@ -118,12 +119,12 @@ void A_FirstSighting (entity_t *self)
 {
     switch (self->type) {
     case en_guard:
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/001.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/001.wav"));
         self->speed *= 3;   // go faster when chasing player
         break;
 
     case en_officer:
-        //  Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/071.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/071.wav"));
         self->speed *= 5;   // go faster when chasing player
         break;
 
@@ -132,52 +133,52 @@ void A_FirstSighting (entity_t *self)
         break;
 
     case en_ss:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/015.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/015.wav"));
         self->speed *= 4;           // go faster when chasing player
         break;
 
     case en_dog:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/002.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/002.wav"));
         self->speed *= 2;           // go faster when chasing player
         break;
 
     case en_boss:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/017.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/017.wav"));
         self->speed = SPDPATROL * 3;    // go faster when chasing player
         break;
 
     case en_gretel:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/112.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/112.wav"));
         self->speed *= 3;           // go faster when chasing player
         break;
 
     case en_gift:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/096.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/096.wav"));
         self->speed *= 3;           // go faster when chasing player
         break;
 
     case en_fat:
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/102.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/102.wav"));
         self->speed *= 3;           // go faster when chasing player
         break;
 
     case en_schabbs:
-      //  Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/065.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/065.wav"));
         self->speed *= 3;           // go faster when chasing player
         break;
 
     case en_fake:
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/054.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/054.wav"));
         self->speed *= 3;           // go faster when chasing player
         break;
 
     case en_mecha:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/040.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/040.wav"));
         self->speed *= 3;           // go faster when chasing player
         break;
 
     case en_hitler:
-       // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/040.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/040.wav"));
         self->speed *= 5;           // go faster when chasing player
         break;
 
@@ -210,8 +211,9 @@ static void A_KillActor (entity_t *self)
 {
     int tilex, tiley;
 
-    tilex = self->tilex = self->x >> TILE_SHIFT; // drop item on center
-    tiley = self->tiley = self->y >> TILE_SHIFT;
+    tilex = self->x >> TILE_SHIFT; // drop item on center
+    tiley = self->y >> TILE_SHIFT;
+    Actor_SetTile (self, tilex, tiley);
 
     switch (self->type) {
     case en_guard:
@@ -301,9 +303,9 @@ void A_DamageActor (entity_t *self, int damage)
         damage <<= 1;
     }
 
-    self->health -= damage;
+    ACTOR_COLD (self)->health -= damage;
 
-    if (self->health <= 0) {
+    if (ACTOR_COLD (self)->health <= 0) {
         A_KillActor (self);
     } else {
         if (! (self->flags & FL_ATTACKMODE)) {
@@ -315,7 +317,7 @@ void A_DamageActor (entity_t *self, int damage)
         case en_officer:
         case en_mutant:
         case en_ss:
-            if (self->health & 1) {
+            if (ACTOR_COLD (self)->health & 1) {
                 A_StateChange (self, st_pain);
             } else {
                 A_StateChange (self, st_pain1);
@@ -332,9 +334,7 @@ void A_DamageActor (entity_t *self, int damage)
  */
 void A_MechaSound (entity_t *self)
 {
-    if (areabyplayer[ (unsigned char) self->areanumber ]) {
-        //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/080.wav"), 1, ATTN_NORM, 0);
-    }
+    Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/080.wav"));
 }
 
 /**
@@ -343,7 +343,7 @@ void A_MechaSound (entity_t *self)
  */
 void A_Slurpie (entity_t *self)
 {
-   // Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("lsfx/061.wav"), 1, ATTN_NORM, 0);
+    Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("lsfx/061.wav"));
 }
 
 /**
@@ -364,11 +364,10 @@ void A_HitlerMorph (entity_t *self)
     hitler->x = self->x;//
     hitler->y = self->y;//
     hitler->distance = self->distance;
-    hitler->tilex = self->tilex;//
-    hitler->tiley = self->tiley;//
+    Actor_SetTile (hitler, self->tilex, self->tiley);//
     hitler->angle = self->angle;//
     hitler->dir = self->dir;//
-    hitler->health = hitpoints[skill ];
+    ACTOR_COLD (hitler)->health = hitpoints[skill ];
     hitler->areanumber = self->areanumber;
     hitler->state = st_chase1;//
     hitler->type = en_hitler; //
@@ -399,7 +398,7 @@ static int angel_temp = 0;
  */
 void A_Breathing (entity_t *self)
 {
-   // Sound_StartSound (NULL, 0, CHAN_VOICE, Sound_RegisterSound ("lsfx/080.wav"), 1, ATTN_NORM, 0);
+    Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("lsfx/080.wav"));
 }
 
 /**
@@ -427,7 +426,7 @@ void A_Victory (entity_t *self)
 void A_Dormant (entity_t *self)
 {
     int deltax, deltay;
-    int xl, xh, yl, yh, x, y, n;
+    int xl, xh, yl, yh, x, y;
 
     deltax = self->x - Player.position.origin[ 0 ];
 
@@ -455,14 +454,8 @@ moveok:
                 return;
             }
 
-            for (n = 0 ; n < NumGuards ; ++n) {
-                if (Guards[ n ].state >= st_die1) {
-                    continue;
-                }
-
-                if (Guards[ n ].tilex == x && Guards[ n ].tiley == y) {
-                    return; // another guard in path
-                }
+            if (Actor_LiveOnTile (x, y)) {
+                return; // another guard in path
             }
         }
 
@@ -472,7 +465,7 @@ moveok:
     A_StateChange (self, st_path1);
 }
 
-static entity_t *deathcamEnt;
+static actorhandle_t deathcamEnt;
 static int deathcamTime;
 static int deathcamPhase;
 
@@ -481,8 +474,9 @@ static int deathcamPhase;
  */
 static void M_LetsSeeThatAgain_Draw (void)
 {
-    float fangle;
+    int fangle;
     int dist;
+    entity_t *ent = Actor_FromHandle (deathcamEnt);
 
     switch (deathcamPhase) {
     case 0:
@@ -499,17 +493,22 @@ static void M_LetsSeeThatAgain_Draw (void)
         // orient camera and draw message
         // switch away after 300 VBLs, or 4286 ms
         // FIXME: this should be the original position where you killed the boss
-        fangle = TransformPoint (deathcamEnt->x, deathcamEnt->y, Player.position.origin[0], Player.position.origin[1]);
+        if (! ent) {
+            deathcamPhase++; // boss is gone, nothing to look at
+            break;
+        }
+
+        fangle = TransformPoint (ent->x, ent->y, Player.position.origin[0], Player.position.origin[1]);
 
         Player.position.angle = fangle;
 
-        ClientState.viewangles[ YAW ] = RAD2FINE (Player.position.angle);
+        ClientState.viewangles[ YAW ] = Player.position.angle;
 
         dist = 0x14000l;
 
         do {
-            Player.position.origin[0] = (long) (deathcamEnt->x - dist * cos (fangle));
-            Player.position.origin[1] = (long) (deathcamEnt->y - dist * sin (fangle));
+            Player.position.origin[0] = ent->x - FixedMul (dist, FixedCos (fangle));
+            Player.position.origin[1] = ent->y - FixedMul (dist, FixedSin (fangle));
             dist += 0x1000;
 
         } while (!PL_TryMove (&Player, r_world));
@@ -520,7 +519,7 @@ static void M_LetsSeeThatAgain_Draw (void)
 
         if (ClientStatic.realtime >= deathcamTime + 4286) {
             M_ForceMenuOff();
-            A_StateChange (deathcamEnt, st_deathcam);
+            A_StateChange (ent, st_deathcam);
         }
 
         break;
@@ -551,7 +550,7 @@ static const char *M_LetsSeeThatAgain_Key (int key)
  */
 void A_StartDeathCam (entity_t *self)
 {
-    deathcamEnt = self;
+    deathcamEnt = Actor_Handle (self);
     deathcamTime = ClientStatic.realtime;
 
     if (Player.playstate == ex_watchingdeathcam) {
@@ -579,8 +578,7 @@ void A_Smoke (entity_t *self)
 
     smoke->x = self->x;
     smoke->y = self->y;
-    smoke->tilex = self->tilex;
-    smoke->tiley = self->tiley;
+    Actor_SetTile (smoke, self->tilex, self->tiley);
     smoke->state = st_die1;
     smoke->type = en_smoke;
     smoke->ticcount = 6;
@@ -638,8 +636,8 @@ void T_Projectile (entity_t *self)
 
     speed = self->speed * tics;
 
-    deltax = (int) (speed * cos (FINE2RAD (self->angle)));
-    deltay = (int) (speed * sin (FINE2RAD (self->angle)));
+    deltax = FixedMul (speed, FixedCos (self->angle));
+    deltay = FixedMul (speed, FixedSin (self->angle));
 
     if (deltax > TILE_GLOBAL) {
         deltax = TILE_GLOBAL;
@@ -666,7 +664,7 @@ void T_Projectile (entity_t *self)
     if (! ProjectileTryMove (self, r_world)) {
         if (self->type == en_rocket) {
             // rocket ran into obstacle, draw explosion!
-            // Sound_StartSound (NULL, 1, CHAN_WEAPON, Sound_RegisterSound ("lsfx/086.wav"), 1, ATTN_NORM, 0);
+            Actor_Sound (self, CHAN_WEAPON, Sound_RegisterSound ("lsfx/086.wav"));
             A_StateChange (self, st_die1);
         } else {
             A_StateChange (self, st_remove);  // mark for removal
@@ -699,6 +697,5 @@ void T_Projectile (entity_t *self)
         return;
     }
 
-    self->tilex = self->x >> TILE_SHIFT;
-    self->tiley = self->y >> TILE_SHIFT;
+    Actor_SetTile (self, self->x >> TILE_SHIFT, self->y >> TILE_SHIFT);
 }
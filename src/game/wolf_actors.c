@@ -45,12 +45,175 @@
 
 
 entity_t Guards[ MAX_GUARDS + 1 ];
-uint16_t NumGuards = 0;
+entity_cold_t GuardsCold[ MAX_GUARDS + 1 ];
+uint16_t NumGuards = 0;     // number of used slots, length of ActorSlots.live
+actorslots_t ActorSlots;
 uint8_t add8dir[ 9 ] = { 4, 5, 6, 7, 0, 1, 2, 3, 0 };
 uint8_t r_add8dir[ 9 ] = { 4, 7, 6, 5, 0, 1, 2, 3, 0 };
 
+// Tile occupancy: singly linked lists of Guards slots, one per tile.
+#define TILE_NOACTOR    -1
+
+static int16_t tile_first[ 64 ][ 64 ];
+static int16_t tile_next[ MAX_GUARDS + 1 ];
+
+
+/**
+ * \brief Add guard to the occupancy list of its tile.
+ * \param[in] n Index in Guards array.
+ */
+static void Actor_LinkTile (int n)
+{
+    int x = Guards[ n ].tilex;
+    int y = Guards[ n ].tiley;
+
+    assert (x >= 0 && x < 64);
+    assert (y >= 0 && y < 64);
+
+    tile_next[ n ] = tile_first[ x ][ y ];
+    tile_first[ x ][ y ] = n;
+}
+
+/**
+ * \brief Remove guard from the occupancy list of its tile.
+ * \param[in] n Index in Guards array.
+ */
+static void Actor_UnlinkTile (int n)
+{
+    int16_t *link = &tile_first[ (int)Guards[ n ].tilex ][ (int)Guards[ n ].tiley ];
+
+    while (*link != TILE_NOACTOR) {
+        if (*link == n) {
+            *link = tile_next[ n ];
+            return;
+        }
+
+        link = &tile_next[ *link ];
+    }
+}
+
+/**
+ * \brief Rebuild tile occupancy from the Guards array.
+ * \note Needed whenever Guards is moved around or loaded as a block.
+ */
+void Actor_RebuildTileIndex (void)
+{
+    int n;
+
+    memset (tile_first, 0xFF, sizeof (tile_first)); // TILE_NOACTOR
+
+    for (n = 0 ; n < NumGuards ; ++n) {
+        Actor_LinkTile (ActorSlots.live[ n ]);
+    }
+}
+
+/**
+ * \brief Move actor to new tile.
+ * \param[in] ent Valid pointer to an entity_t structure in Guards array.
+ * \param[in] x X position in tile map
+ * \param[in] y Y position in tile map
+ * \note Always use this instead of writing tilex/tiley directly, it keeps tile occupancy in sync.
+ */
+void Actor_SetTile (entity_t *ent, int x, int y)
+{
+    int n = ent - Guards;
+
+    assert (n >= 0 && n <= MAX_GUARDS);
+
+    if (ent->tilex == x && ent->tiley == y) {
+        return;
+    }
+
+    Actor_UnlinkTile (n);
+    ent->tilex = x;
+    ent->tiley = y;
+    Actor_LinkTile (n);
+}
+
+/**
+ * \brief First actor standing on tile.
+ * \param[in] x X position in tile map
+ * \param[in] y Y position in tile map
+ * \return Valid pointer to an entity_t structure, or NULL if tile is empty.
+ */
+entity_t *Actor_FirstOnTile (int x, int y)
+{
+    if (x < 0 || x >= 64 || y < 0 || y >= 64) {
+        return NULL;
+    }
+
+    return tile_first[ x ][ y ] == TILE_NOACTOR ? NULL : &Guards[ tile_first[ x ][ y ] ];
+}
+
+/**
+ * \brief Next actor standing on the same tile.
+ * \param[in] ent Valid pointer to an entity_t structure returned by Actor_FirstOnTile/Actor_NextOnTile.
+ * \return Valid pointer to an entity_t structure, or NULL if there are no more.
+ */
+entity_t *Actor_NextOnTile (entity_t *ent)
+{
+    int n = tile_next[ ent - Guards ];
+
+    return n == TILE_NOACTOR ? NULL : &Guards[ n ];
+}
+
+/**
+ * \brief Is there a living actor on tile?
+ * \param[in] x X position in tile map
+ * \param[in] y Y position in tile map
+ * \return true if an actor that is not dying or dead stands on tile, otherwise false.
+ */
+bool Actor_LiveOnTile (int x, int y)
+{
+    entity_t *ent;
+
+    for (ent = Actor_FirstOnTile (x, y) ; ent ; ent = Actor_NextOnTile (ent)) {
+        if (ent->state < st_die1) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 
 
+/**
+ * \brief Get handle of actor.
+ * \param[in] ent Valid pointer to an entity_t structure in Guards array, or NULL.
+ * \return Handle that can be kept across tics, ACTOR_NOHANDLE if ent is NULL.
+ */
+actorhandle_t Actor_Handle (entity_t *ent)
+{
+    int n;
+
+    if (! ent) {
+        return ACTOR_NOHANDLE;
+    }
+
+    n = ent - Guards;
+    assert (n >= 0 && n <= MAX_GUARDS);
+
+    return ((actorhandle_t)ActorSlots.generation[ n ] << 16) | n;
+}
+
+/**
+ * \brief Resolve actor handle.
+ * \param[in] handle Handle returned by Actor_Handle.
+ * \return Valid pointer to an entity_t structure, or NULL if the actor was removed since.
+ */
+entity_t *Actor_FromHandle (actorhandle_t handle)
+{
+    int n = handle & 0xFFFF;
+
+    if (handle == ACTOR_NOHANDLE || n > MAX_GUARDS ||
+            ActorSlots.generation[ n ] != (handle >> 16)) {
+        return NULL;
+    }
+
+    return &Guards[ n ];
+}
+
 /**
  * \brief Changes guard's state to that defined by newState.
  * \param[in] self Valid Pointer to an entity_t structure to change state.
@@ -77,19 +240,22 @@ void A_StateChange (entity_t *ent, en_state newState)
 static int DoGuard (entity_t *ent)  // FIXME: revise!
 {
     think_t think;
+    const stateinfo *states; // actors never change type, so look the row up once
 
     assert (ent->tilex >= 0 && ent->tilex < 64);
     assert (ent->tiley >= 0 && ent->tiley < 64);
     assert (ent->dir >= 0 && ent->dir <= 8);
+    assert (ent->type >= 0 && ent->type < NUMENEMIES);
+
+    states = objstate[ ent->type ];
 
     // ticcounts fire discrete actions separate from think functions
     if (ent->ticcount) {
         ent->ticcount -= tics;
 
         while (ent->ticcount <= 0) {
-            assert (ent->type >= 0 && ent->type < NUMENEMIES);
             assert (ent->state >= 0 && ent->state < NUMSTATES);
-            think = objstate[ ent->type ][ ent->state ].action; // end of state action
+            think = states[ ent->state ].action; // end of state action
 
             if (think) {
                 think (ent);
@@ -99,26 +265,25 @@ static int DoGuard (entity_t *ent)  // FIXME: revise!
                 }
             }
 
-            ent->state = objstate[ ent->type ][ ent->state ].next_state;
+            ent->state = states[ ent->state ].next_state;
 
             if (ent->state == st_remove) {
                 return 0;
             }
 
-            if (! objstate[ ent->type ][ ent->state ].timeout) {
+            if (! states[ ent->state ].timeout) {
                 ent->ticcount = 0;
                 break;
             }
 
-            ent->ticcount += objstate[ ent->type ][ ent->state ].timeout;
+            ent->ticcount += states[ ent->state ].timeout;
         }
     }
 //
 // think
 //
-    assert (ent->type >= 0 && ent->type < NUMENEMIES);
     assert (ent->state >= 0 && ent->state < NUMSTATES);
-    think = objstate[ ent->type ][ ent->state ].think;
+    think = states[ ent->state ].think;
 
     if (think) {
         think (ent);
@@ -134,41 +299,201 @@ static int DoGuard (entity_t *ent)  // FIXME: revise!
 /**
  * \brief Remove guard from guards list
  * \param[in] self Valid Pointer to an entity_t structure to remove
+ * \note The slot goes back on the free list and its generation changes, so
+ *       handles to the removed actor stop resolving. Other actors stay put.
  */
 static void RemoveActor (entity_t *actor)
 {
+    int n = actor - Guards;
+    int pos = ActorSlots.live_pos[ n ];
+
+    assert (n >= 0 && n <= MAX_GUARDS);
+    assert (pos < NumGuards && ActorSlots.live[ pos ] == n);
+
     Sprite_RemoveSprite (actor->sprite);
-    memmove (actor, actor + 1, (intptr_t) (&Guards[ NumGuards ]) - (intptr_t) (actor + 1));
+    Actor_UnlinkTile (n);
+
+    // fill the hole in the live list with its last entry
     NumGuards--;
+    ActorSlots.live[ pos ] = ActorSlots.live[ NumGuards ];
+    ActorSlots.live_pos[ ActorSlots.live[ pos ] ] = pos;
+
+    if (++ActorSlots.generation[ n ] == 0) {
+        ActorSlots.generation[ n ] = 1; // 0 is never a valid generation
+    }
+
+    ActorSlots.free[ ActorSlots.numfree++ ] = n;
+}
+
+#define LOD_FAR_TILES       20  // beyond this actors in the player's areas think every LOD_FAR_TICS
+#define LOD_FAR_TICS        2
+#define LOD_DORMANT_TICS    8   // actors in areas not connected to the player
+
+actorlod_stats_t actorlod_stats;
+
+/**
+ * \brief Does a slowed down actor sit this tic out?
+ * \param[in] slot Actor's slot in Guards
+ * \param[in] period Tics between thinks, power of two
+ * \return true if it is not this actor's tic to think.
+ * \note Taken from the level time and the slot only, so a saved, rewound or
+ *       replayed level staggers its actors the same way; the slot spreads
+ *       actors over the period so they don't all think on the same tic.
+ */
+static bool Actor_LODWait (int slot, int period)
+{
+    return (((uint32_t) levelstate.time + slot) & (period - 1)) != 0;
+}
+
+/**
+ * \brief How often does an actor need to think?
+ * \param[in] ent Actor
+ * \param[in] st Actor's current state
+ * \return Tics between thinks, power of two; 0 if thinking would do nothing.
+ * \note Only idle actors that can't notice the player soon are slowed down.
+ */
+static int Actor_ThinkPeriod (entity_t *ent, const stateinfo *st)
+{
+    int dx, dy;
+
+    if (! ent->ticcount && ! st->think) {
+        return 0; // at rest, e.g. a body
+    }
+
+    if (Player.madenoise || ent->type >= en_needle || ent->reacttime ||
+            (ent->flags & FL_ATTACKMODE) || ent->state > st_path4) {
+        return 1;
+    }
+
+    if (! areabyplayer[ (unsigned char) ent->areanumber ]) {
+        return LOD_DORMANT_TICS; // behind closed doors, can't see or hear the player
+    }
+
+    dx = ABS (ent->tilex - POS2TILE (Player.position.origin[ 0 ]));
+    dy = ABS (ent->tiley - POS2TILE (Player.position.origin[ 1 ]));
+
+    if (dx > LOD_FAR_TILES || dy > LOD_FAR_TILES) {
+        return LOD_FAR_TICS;
+    }
+
+    return 1;
+}
+
+static los_query_t sense_lines[ MAX_GUARDS + 1 ];    // one per slot, see ActorSlots
+
+/**
+ * \brief Sense phase: trace the sight lines of the actors about to think.
+ * \note Nothing is changed but the LOS cache, the act phase still asks
+ *       Level_CheckLine and gets the same answers as without it.
+ */
+static void Actor_Sense (void)
+{
+    int n, period, count = 0;
+    entity_t *ent;
+    los_query_t *q;
+
+    for (n = 0 ; n < NumGuards ; ++n) {
+        ent = LIVE_GUARD (n);
+
+        if (ent->type >= en_needle || ent->state >= st_die1) {
+            continue; // doesn't look
+        }
+
+        period = Actor_ThinkPeriod (ent, &objstate[ ent->type ][ ent->state ]);
+
+        if (! period || period == LOD_DORMANT_TICS ||
+                (period > 1 && Actor_LODWait (ActorSlots.live[ n ], period))) {
+            continue; // won't think this tic
+        }
+
+        q = &sense_lines[ count++ ];
+        q->x1 = ent->x;
+        q->y1 = ent->y;
+        q->x2 = Player.position.origin[ 0 ];
+        q->y2 = Player.position.origin[ 1 ];
+    }
+
+    Level_CheckLines (sense_lines, count, r_world);
 }
 
 /**
  * \brief Process all guards currently in game.
  * \note This method should be called every frame
+ * \note Slowed down actors run with tics set to the time they missed, so
+ *       ticcount and movement catch up exactly; a door joining their area or
+ *       noise brings them back to every tic at once.
+ * \note Sight lines are traced first, in parallel, see Actor_Sense; the
+ *       actors then act one after the other in list order.
  */
 void ProcessGuards (void)
 {
-    int n, tex;
+    int n, tex, period, saved_tics;
+    entity_t *ent;
+    const stateinfo *st;
+    bool alive;
     assert (NumGuards < MAX_GUARDS);
 
+    actorlod_stats.thinks = actorlod_stats.skipped = 0;
+
+    Actor_Sense ();
+
     for (n = 0 ; n < NumGuards ; ++n) {
-        if (! DoGuard (&Guards[ n ])) {
+        ent = LIVE_GUARD (n);
+        st = &objstate[ ent->type ][ ent->state ];
+        period = Actor_ThinkPeriod (ent, st);
+
+        if (! period) {
+            ent->lodtics = 0;
+            actorlod_stats.skipped++;
+
+            if (! st->rotate) {
+                continue; // nothing can change
+            }
+
+            goto sprite;
+        }
+
+        ent->lodtics += tics;
+
+        if (period > 1 && ent->lodtics < 255 - tics && Actor_LODWait (ActorSlots.live[ n ], period)) {
+            actorlod_stats.skipped++;
+
+            if (period == LOD_DORMANT_TICS) {
+                continue; // out of sight
+            }
+
+            goto sprite;
+        }
+
+        actorlod_stats.thinks++;
+        saved_tics = tics;
+        tics = ent->lodtics;
+        ent->lodtics = 0;
+        alive = DoGuard (ent);
+        tics = saved_tics;
+
+        if (! alive) {
             // remove guard from the game forever!
-            RemoveActor (&Guards[ n-- ]);
+            // the last live guard takes its place, so look at this index again
+            RemoveActor (ent);
+            n--;
             continue;
         }
 
-        Sprite_SetPos (Guards[ n ].sprite, Guards[ n ].x, Guards[ n ].y, Guards[ n ].angle);
-        tex = objstate[ Guards[ n ].type ][ Guards[ n ].state ].texture;
+        st = &objstate[ ent->type ][ ent->state ];
+
+sprite:
+        Sprite_SetPos (ent->sprite, ent->x, ent->y, ent->angle);
+        tex = st->texture;
 
-        if (objstate[ Guards[ n ].type ][ Guards[ n ].state ].rotate) {
-            if (Guards[ n ].type == en_rocket) {
-                tex += r_add8dir[ Get8dir(angle_wise(Player.position.angle, FINE2RAD (Guards[ n ].angle))) ];
+        if (st->rotate) {
+            if (ent->type == en_rocket) {
+                tex += r_add8dir[ Get8dir (Player.position.angle - ent->angle) ];
             } else {
-                tex += add8dir[ Get8dir(angle_wise(Player.position.angle, FINE2RAD (Guards[ n ].angle))) ];
+                tex += add8dir[ Get8dir (Player.position.angle - ent->angle) ];
             }
         }
-        Sprite_SetTex (Guards[ n ].sprite, 0, tex);
+        Sprite_SetTex (ent->sprite, 0, tex);
     }
 }
 
@@ -177,8 +502,21 @@ void ProcessGuards (void)
  */
 void ResetGuards (void)
 {
+    int n;
+
     memset (Guards, 0, sizeof (Guards));
+    memset (GuardsCold, 0, sizeof (GuardsCold));
     NumGuards = 0;
+
+    // hand out low slots first
+    ActorSlots.numfree = 0;
+
+    for (n = MAX_GUARDS ; n >= 0 ; --n) {
+        ActorSlots.free[ ActorSlots.numfree++ ] = n;
+        ActorSlots.generation[ n ] = 1;
+    }
+
+    Actor_RebuildTileIndex();
 }
 
 /**
@@ -187,13 +525,46 @@ void ResetGuards (void)
  */
 entity_t *GetNewActor (void)
 {
-    if (NumGuards > MAX_GUARDS) {
+    int n;
+
+    if (! ActorSlots.numfree) {
         return NULL;
     }
 
-    memset (&Guards[ NumGuards ], 0, sizeof (Guards[ 0 ]));
+    n = ActorSlots.free[ --ActorSlots.numfree ];
+
+    memset (&Guards[ n ], 0, sizeof (Guards[ 0 ]));
+    memset (&GuardsCold[ n ], 0, sizeof (GuardsCold[ 0 ]));
+    Actor_LinkTile (n); // tile 0,0 until placed
+
+    ActorSlots.live[ NumGuards ] = n;
+    ActorSlots.live_pos[ n ] = NumGuards;
+    NumGuards++;
+
+    return &Guards[ n ];
+}
+
+/**
+ * \brief Play a sound where an actor stands.
+ * \param[in] self Valid pointer to an entity_t structure.
+ * \param[in] channel Channel of the actor, the sound cuts off what it played there.
+ * \param[in] sfx Sound to play.
+ * \note Left out if the actor's area isn't connected to the player's, like the original game.
+ */
+void Actor_Sound (entity_t *self, int channel, sfx_t *sfx)
+{
+    int32_t origin[ 2 ];
+
+    if (! areabyplayer[ (unsigned char) self->areanumber ]) {
+        soundfx_stats.culled++;
+        return;
+    }
+
+    origin[ 0 ] = self->x;
+    origin[ 1 ] = self->y;
 
-    return &Guards[ NumGuards++ ];
+    // entity 0 is the player
+    Sound_StartSound (origin, 1 + (int) (self - Guards), channel, sfx, 1, ATTN_NORM, 0);
 }
 
 /**
@@ -218,8 +589,7 @@ entity_t *SpawnActor (enemy_t which, int x, int y, dir4type dir, LevelData_t *lv
     new_actor->x = TILE2POS (x);
     new_actor->y = TILE2POS (y);
 
-    new_actor->tilex = x;
-    new_actor->tiley = y;
+    Actor_SetTile (new_actor, x, y);
 
     assert (dir >= 0 && dir <= 4);
     new_actor->angle = dir4angle[ dir ];
@@ -235,7 +605,7 @@ entity_t *SpawnActor (enemy_t which, int x, int y, dir4type dir, LevelData_t *lv
     assert (new_actor->areanumber >= 0 && new_actor->areanumber < NUMAREAS);
     new_actor->type = which;
 
-    new_actor->health = starthitpoints[skill ][ which ];
+    ACTOR_COLD (new_actor)->health = starthitpoints[skill ][ which ];
     new_actor->sprite = Sprite_GetNewSprite();
 
     return new_actor;
@@ -315,7 +685,7 @@ void SpawnDeadGuard (enemy_t which, int x, int y)
 
     self->state = st_dead;
     self->speed = 0;
-    self->health = 0;
+    ACTOR_COLD (self)->health = 0;
     self->ticcount = objstate[ which ][ st_dead ].timeout ? US_RndT() % objstate[ which ][ st_dead ].timeout + 1 : 0;
 
 }
@@ -358,7 +728,7 @@ void SpawnBoss (enemy_t which, int x, int y)
 
     self->state = st_stand;
     self->speed = SPDPATROL;
-    self->health = starthitpoints[skill ][ which ];
+    ACTOR_COLD (self)->health = starthitpoints[skill ][ which ];
     self->ticcount = objstate[ which ][ st_stand ].timeout ? US_RndT() % objstate[ which ][ st_stand ].timeout + 1 : 0;
     self->flags |= FL_SHOOTABLE | FL_AMBUSH;
 
@@ -383,7 +753,7 @@ void SpawnGhosts (enemy_t which, int x, int y)
 
     self->state = st_chase1;
     self->speed = SPDPATROL * 3;
-    self->health = starthitpoints[skill ][ which ];
+    ACTOR_COLD (self)->health = starthitpoints[skill ][ which ];
     self->ticcount = objstate[ which ][ st_chase1 ].timeout ? US_RndT() % objstate[ which ][ st_chase1 ].timeout + 1 : 0;
     self->flags |= FL_AMBUSH;
 
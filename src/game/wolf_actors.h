@@ -47,6 +47,7 @@
 
 #include "wolf_math.h"
 #include "wolf_level.h"
+#include "../sound/soundfx.h"
 
 #define SPDPATROL   512
 #define SPDDOG      1500
@@ -104,25 +105,31 @@ typedef enum {
 } en_state;
 
 typedef struct entity_s {
+// touched every tic by ProcessGuards and the think functions
     int x, y;
-    int angle;
-    enemy_t type;
-    int health;         /* Hit points before death */
-    int max_health;
-    int speed;          /* Speed of motion */
     int ticcount;       /* Time before motion */
-    int reacttime;      /* Time to react to the player */
+    en_state state;
+    enemy_t type;
+    dir8type dir;       /* directions for motion */
     int distance;       /* Distance to travel before change */
+    int speed;          /* Speed of motion */
+    int angle;
+    int sprite;
     char tilex, tiley;
     char areanumber;
-    int     waitfordoorx, waitfordoory; // waiting on this door if non 0
+    uint8_t waitfordoorx, waitfordoory; // waiting on this door if non 0
     uint8_t flags;           /* State flags (See above) */
-    en_state state;
-    dir8type dir;       /* directions for motion */
-    int sprite;
+    uint8_t lodtics;    // tics owed since the last think (see ProcessGuards)
+    int reacttime;      /* Time to react to the player */
 
 } entity_t;
 
+// rarely touched, kept out of entity_t so more actors fit in cache; see ACTOR_COLD
+typedef struct {
+    int health;         /* Hit points before death */
+
+} entity_cold_t;
+
 typedef void (*think_t) (entity_t *self);
 
 typedef struct {
@@ -135,16 +142,53 @@ typedef struct {
 } stateinfo;
 
 
+// Guards slots are stable: an actor keeps its slot until it is removed.
+// Iterate live actors with LIVE_GUARD( 0 .. NumGuards - 1 ).
+typedef struct {
+    uint16_t live[ MAX_GUARDS + 1 ];        // used slots, NumGuards long, in no particular order
+    uint16_t live_pos[ MAX_GUARDS + 1 ];    // slot -> index in live
+    uint16_t free[ MAX_GUARDS + 1 ];        // stack of unused slots
+    uint16_t numfree;
+    uint16_t generation[ MAX_GUARDS + 1 ];  // bumped when a slot is freed
+} actorslots_t;
+
+// generation << 16 | slot; survives save games, detects removed actors
+typedef uint32_t actorhandle_t;
+#define ACTOR_NOHANDLE  0
+
+#define LIVE_GUARD( n ) ( &Guards[ ActorSlots.live[ n ] ] )
+#define ACTOR_COLD( ent ) ( &GuardsCold[ (ent) - Guards ] )
+
 extern Deque *guards;
 
 extern entity_t Guards[ MAX_GUARDS + 1 ];
+extern entity_cold_t GuardsCold[ MAX_GUARDS + 1 ];
 extern uint16_t NumGuards;
+extern actorslots_t ActorSlots;
 extern stateinfo objstate[ NUMENEMIES ][ NUMSTATES ];
 
+typedef struct {
+    uint32_t thinks;    // actors run by the last ProcessGuards
+    uint32_t skipped;   // actors left dormant or at rest
+} actorlod_stats_t;
+
+extern actorlod_stats_t actorlod_stats;
+
 void ResetGuards (void);
 
 
 entity_t *GetNewActor (void);
+actorhandle_t Actor_Handle (entity_t *ent);
+entity_t *Actor_FromHandle (actorhandle_t handle);
+
+void Actor_RebuildTileIndex (void);
+void Actor_SetTile (entity_t *ent, int x, int y);
+entity_t *Actor_FirstOnTile (int x, int y);
+entity_t *Actor_NextOnTile (entity_t *ent);
+bool Actor_LiveOnTile (int x, int y);
+
+void Actor_Sound (entity_t *self, int channel, sfx_t *sfx);
+
 entity_t *SpawnActor (enemy_t which, int x, int y, dir4type dir, LevelData_t *lvl);
 void A_StateChange (entity_t *Guard, en_state NewState);
 
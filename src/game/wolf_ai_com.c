@@ -36,6 +36,8 @@
 #include "wolf_player.h"
 #include "wolf_actor_ai.h"
 #include "wolf_local.h"
+#include "wolf_level.h"
+#include "../sound/soundfx.h"
 
 #define RUNSPEED    6000
 
@@ -51,7 +53,6 @@
 int AI_ChangeDir (entity_t *self, dir8type new_dir, LevelData_t *lvl)
 {
     int oldx, oldy, newx, newy; // all it tiles
-    int n;
 
     oldx = POS2TILE (self->x);
     oldy = POS2TILE (self->y);
@@ -66,18 +67,10 @@ int AI_ChangeDir (entity_t *self, dir8type new_dir, LevelData_t *lvl)
             return 0;
         }
 
-        for (n = 0 ; n < NumGuards ; ++n) {
-            if (Guards[ n ].state >= st_die1)
-                continue;
-
-            if (Guards[ n ].tilex == newx && Guards[ n ].tiley == newy)
-                return 0; // another guard in path
-
-            if (Guards[ n ].tilex == oldx && Guards[ n ].tiley == newy)
-                return 0; // another guard in path
-
-            if (Guards[ n ].tilex == newx && Guards[ n ].tiley == oldy)
-                return 0; // another guard in path
+        if (Actor_LiveOnTile (newx, newy) ||
+                Actor_LiveOnTile (oldx, newy) ||
+                Actor_LiveOnTile (newx, oldy)) {
+            return 0; // another guard in path
         }
     } else { // linear dir (E, N, W, S)
         if (lvl->tilemap[ newx ][ newy ] & SOLID_TILE) {
@@ -86,7 +79,7 @@ int AI_ChangeDir (entity_t *self, dir8type new_dir, LevelData_t *lvl)
 
         if (lvl->tilemap[ newx ][ newy ] & DOOR_TILE) {
             if (self->type == en_fake || self->type == en_dog) { // they can't open doors
-                if (lvl->Doors.DoorMap[ newx ][ newy ].action != dr_open) { // path is blocked by a closed opened door
+                if (DOOR_AT (&lvl->Doors, newx, newy)->action != dr_open) { // path is blocked by a closed opened door
                     return 0;
                 }
             } else {
@@ -96,20 +89,13 @@ int AI_ChangeDir (entity_t *self, dir8type new_dir, LevelData_t *lvl)
             }
         }
 
-        for (n = 0 ; n < NumGuards ; ++n) {
-            if (Guards[ n ].state >= st_die1) {
-                continue;
-            }
-
-            if (Guards[ n ].tilex == newx && Guards[ n ].tiley == newy) {
-                return 0; // another guard in path
-            }
+        if (Actor_LiveOnTile (newx, newy)) {
+            return 0; // another guard in path
         }
     }
 
 moveok:
-    self->tilex = newx;
-    self->tiley = newy;
+    Actor_SetTile (self, newx, newy);
 
     lvl->tilemap[ oldx ][ oldy ] &= ~ACTOR_TILE; // update map status
     lvl->tilemap[ newx ][ newy ] |= ACTOR_TILE;
@@ -158,6 +144,56 @@ void AI_Path (entity_t *self)
     }
 }
 
+/**
+ * \brief Pick the sign of one axis from the flow field.
+ * \param[in] delta Tiles to the player along the axis
+ * \param[in] plus The field leads along the positive axis
+ * \param[in] minus The field leads along the negative axis
+ * \param[in] only_flow Set to true to drop the axis if the field doesn't lead along it.
+ * \return New delta, same size as before (at least 1 if the field leads along the axis).
+ */
+static int AI_FlowAxis (int delta, bool plus, bool minus, bool only_flow)
+{
+    int size = delta ? ABS (delta) : 1;
+
+    if (plus && (! minus || delta >= 0)) {
+        return size;
+    }
+
+    if (minus) {
+        return -size;
+    }
+
+    return only_flow ? 0 : delta;
+}
+
+/**
+ * \brief Bend the straight line to the player around walls.
+ * \param[in] self Valid pointer to entity_t structure of entity
+ * \param[in,out] deltax Tiles to the player along x
+ * \param[in,out] deltay Tiles to the player along y
+ * \param[in] away Set to true if the entity runs away from the player.
+ * \param[in] only_flow Set to true to zero an axis the flow field doesn't lead along.
+ * \note The deltas are left alone if the player can't be reached on foot.
+ */
+static void AI_FlowSteer (entity_t *self, int *deltax, int *deltay, bool away, bool only_flow)
+{
+    int mask = Flow_Gradient (r_world, POS2TILE (self->x), POS2TILE (self->y),
+                              self->type != en_fake && self->type != en_dog, away);
+
+    if (! mask) {
+        return;
+    }
+
+    if (away) { // the deltas still point at the player
+        *deltax = AI_FlowAxis (*deltax, mask & BIT (dir4_west), mask & BIT (dir4_east), only_flow);
+        *deltay = AI_FlowAxis (*deltay, mask & BIT (dir4_south), mask & BIT (dir4_north), only_flow);
+    } else {
+        *deltax = AI_FlowAxis (*deltax, mask & BIT (dir4_east), mask & BIT (dir4_west), only_flow);
+        *deltay = AI_FlowAxis (*deltay, mask & BIT (dir4_north), mask & BIT (dir4_south), only_flow);
+    }
+}
+
 /**
  * \brief Attempts to choose and initiate a movement for entity that sends it towards the player while dodging.
  * \param[in] self Valid pointer to entity_t structure of entity to change
@@ -177,6 +213,7 @@ static void AI_Dodge (entity_t *self)
 
     deltax = POS2TILE (Player.position.origin[ 0 ]) - POS2TILE (self->x);
     deltay = POS2TILE (Player.position.origin[ 1 ]) - POS2TILE (self->y);
+    AI_FlowSteer (self, &deltax, &deltay, false, false);
 
 //
 // arange 5 direction choices in order of preference
@@ -258,6 +295,7 @@ static void AI_Chase (entity_t *self)
 
     deltax = POS2TILE (Player.position.origin[ 0 ]) - POS2TILE (self->x);
     deltay = POS2TILE (Player.position.origin[ 1 ]) - POS2TILE (self->y);
+    AI_FlowSteer (self, &deltax, &deltay, false, true);
 
     if (deltax > 0) {
         d[ 0 ] = dir8_east;
@@ -343,6 +381,7 @@ static void AI_Retreat (entity_t *self)
 
     deltax = POS2TILE (Player.position.origin[ 0 ]) - POS2TILE (self->x);
     deltay = POS2TILE (Player.position.origin[ 1 ]) - POS2TILE (self->y);
+    AI_FlowSteer (self, &deltax, &deltay, true, false);
 
     d[ 0 ] = deltax < 0 ? dir8_east  : dir8_west;
     d[ 1 ] = deltay < 0 ? dir8_north : dir8_south;
@@ -396,7 +435,7 @@ static bool AI_CheckSight (entity_t *self)
 
 // don't bother tracing a line if the area isn't connected to the player's
     if (! (self->flags & FL_AMBUSH)) {
-        if (! areabyplayer[ self->areanumber ]) {
+        if (! areabyplayer[ (unsigned char) self->areanumber ]) {
             return false;
         }
     }
@@ -464,7 +503,7 @@ static bool AI_FindTarget (entity_t *self)
 
         assert (self->areanumber >= 0 && self->areanumber <  NUMAREAS);
 
-        if (! (self->flags & FL_AMBUSH) && ! areabyplayer[ self->areanumber ]) {
+        if (! (self->flags & FL_AMBUSH) && ! areabyplayer[ (unsigned char) self->areanumber ]) {
             return false;
         }
 
@@ -579,7 +618,7 @@ void T_Advance (entity_t *self, think_t think)
 
 // waiting for a door to open
         if (self->waitfordoorx) {
-            doors_t *door = &r_world->Doors.DoorMap[ self->waitfordoorx ][ self->waitfordoory ];
+            doors_t *door = DOOR_AT (&r_world->Doors, self->waitfordoorx, self->waitfordoory);
 
             Door_Open (door);
 
@@ -725,7 +764,7 @@ void T_Bite (entity_t *self)
     long dx, dy;
 
 //  Sound_StartSound( NULL, 1, CHAN_VOICE, Sound_RegisterSound( "lsfx/076.wav" ), 1, ATTN_NORM, 0 );  //gsh this was the original code
-    //Sound_StartSound (NULL, 1, CHAN_VOICE, Sound_RegisterSound ("sfx/002.wav"), 1, ATTN_NORM, 0);    //gsh changed to this... the original code wasn't the correct sound file
+    Actor_Sound (self, CHAN_VOICE, Sound_RegisterSound ("sfx/002.wav"));    //gsh changed to this... the original code wasn't the correct sound file
 
     dx = ABS (Player.position.origin[ 0 ] - self->x) - TILE_GLOBAL;
 
@@ -853,7 +892,7 @@ void T_Shoot (entity_t *self)
     int dx, dy, dist;
     int hitchance, damage;
 
-    if (! areabyplayer[ self->areanumber ]) {
+    if (! areabyplayer[ (unsigned char) self->areanumber ]) {
         return;
     }
 
@@ -879,7 +918,7 @@ void T_Shoot (entity_t *self)
 // player can see to dodge
 // (if CheckLine both player & enemy see each other)
 // So left only check if guard is in player's fov: FIXME: not fixed fov!
-    if (angle_diff (TransformPoint (self->x, self->y, Player.position.origin[0], Player.position.origin[1]), RAD2DEG (Player.position.angle)) < (M_PI / 3)) {
+    if (FineDiff (TransformPoint (self->x, self->y, Player.position.origin[0], Player.position.origin[1]), Player.position.angle) < ANG_180 / 3) {
         hitchance -= dist * 16;
     } else {
         hitchance -= dist * 8;
@@ -900,7 +939,7 @@ void T_Shoot (entity_t *self)
 
     switch (self->type) {
     case en_ss:
-        // Sound_StartSound (NULL, 1, CHAN_WEAPON, Sound_RegisterSound ("sfx/024.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_WEAPON, Sound_RegisterSound ("sfx/024.wav"));
         break;
 
     case en_gift:
@@ -908,11 +947,11 @@ void T_Shoot (entity_t *self)
     case en_mecha:
     case en_hitler:
     case en_boss:
-       // Sound_StartSound (NULL, 1, CHAN_WEAPON, Sound_RegisterSound ("sfx/022.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_WEAPON, Sound_RegisterSound ("sfx/022.wav"));
         break;
 
     default:
-        // Sound_StartSound (NULL, 1, CHAN_WEAPON, Sound_RegisterSound ("sfx/049.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_WEAPON, Sound_RegisterSound ("sfx/049.wav"));
         break;
     }
 }
@@ -943,13 +982,9 @@ void T_UShoot (entity_t *self)
 void T_Launch (entity_t *self)
 {
     entity_t *proj;
-    float iangle;
-
-    iangle = TransformPoint (self->x, self->y, Player.position.origin[ 0 ], Player.position.origin[ 1 ]) + M_PI;
+    int iangle;
 
-    if (iangle > 2 * M_PI) {
-        iangle -= 2 * M_PI;
-    }
+    iangle = FineNormalize (TransformPoint (self->x, self->y, Player.position.origin[ 0 ], Player.position.origin[ 1 ]) + ANG_180);
 
     proj = GetNewActor();
 
@@ -960,14 +995,13 @@ void T_Launch (entity_t *self)
     proj->x = self->x;
     proj->y = self->y;
 
-    proj->tilex = self->tilex;
-    proj->tiley = self->tiley;
+    Actor_SetTile (proj, self->tilex, self->tiley);
 
     proj->state = st_stand;
     proj->ticcount = 1;
     proj->dir = dir8_nodir;
 
-    proj->angle = (int)RAD2FINE (iangle);
+    proj->angle = iangle;
     proj->speed = 0x2000;
     proj->flags = (uint8_t)FL_NONMARK; // FL_NEVERMARK;
     proj->sprite = Sprite_GetNewSprite();
@@ -978,17 +1012,17 @@ void T_Launch (entity_t *self)
         proj->state = st_path1;
         proj->flags = FL_NEVERMARK;
         proj->speed = 0x1600;
-       // Sound_StartSound (NULL, 1, CHAN_WEAPON, Sound_RegisterSound ("lsfx/069.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_WEAPON, Sound_RegisterSound ("lsfx/069.wav"));
         break;
 
     case en_schabbs:
         proj->type = en_needle;
         proj->state = st_path1;
-       // Sound_StartSound (NULL, 1, CHAN_WEAPON, Sound_RegisterSound ("lsfx/008.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_WEAPON, Sound_RegisterSound ("lsfx/008.wav"));
         break;
 
     default:
         proj->type = en_rocket;
-            //  Sound_StartSound (NULL, 1, CHAN_WEAPON, Sound_RegisterSound ("lsfx/085.wav"), 1, ATTN_NORM, 0);
+        Actor_Sound (self, CHAN_WEAPON, Sound_RegisterSound ("lsfx/085.wav"));
     }
 }
\ No newline at end of file
@@ -38,8 +38,11 @@
 
     Areaconnect is incremented/decremented by each door. If >0 they connect.
 
-    Every time a door opens or closes the areabyplayer matrix gets recalculated.
-    An area is true if it connects with the player's current position.
+    areabyplayer is true for every area that connects with the player's current
+    position. It is kept up to date as doors join and part areas: each area has
+    a bitset row of the areas it touches, a new connection merges the other
+    side's component in, and a lost connection only re-floods the player's
+    component when both sides were part of it.
 
 */
 
@@ -47,37 +50,77 @@
 
 #include "wolf_level.h"
 
+#define AREA_BIT( n )   ( (uint64_t)1 << (n) )
+
 
 uint8_t areaconnect[ NUMAREAS ][ NUMAREAS ];    /* Is this area mated with another? */
  bool    areabyplayer[ NUMAREAS ];               /* Which areas can I see into? */
 
+static uint64_t area_adjacent[ NUMAREAS ];      // bit i set if areaconnect[ n ][ i ] > 0
+static uint64_t player_areas;                   // areabyplayer as a bitset
+static int player_area;
 
 
 /**
- * \brief Recursive routine to properly set the areabyplayer array by using the contents of the areaconnect array.
- * \param[in] area_number Area to connect
+ * \brief Find every area connected to an area.
+ * \param[in] area_number Area to start from
+ * \return Bitset of the connected areas, including area_number.
+ * \note Breadth first, one whole frontier of areas per step.
  */
-static void Areas_RecursiveConnect (int area_number)
+static uint64_t Areas_Reach (int area_number)
 {
+    uint64_t reach = AREA_BIT (area_number);
+    uint64_t frontier = reach;
+    uint64_t next, bits;
     int i;
 
-    for (i = 0 ; i < NUMAREAS ; ++i) {
-        if (areaconnect[ area_number ][ i ] && ! areabyplayer[ i ]) {
-            areabyplayer[ i ] = true;
-            Areas_RecursiveConnect (i);  /* Link it in... */
+    while (frontier) {
+        next = 0;
+
+        for (i = 0, bits = frontier ; bits ; ++i, bits >>= 1) {
+            if (bits & 1) {
+                next |= area_adjacent[ i ];
+            }
         }
+
+        frontier = next & ~reach;
+        reach |= frontier;
     }
+
+    return reach;
+}
+
+/**
+ * \brief Set the areas connected with the player.
+ * \param[in] areas Bitset of areas
+ * \note Only the entries of areabyplayer that changed are written.
+ */
+static void Areas_SetPlayerAreas (uint64_t areas)
+{
+    uint64_t changed = areas ^ player_areas;
+    int i;
+
+    for (i = 0 ; changed ; ++i, changed >>= 1) {
+        if (changed & 1) {
+            areabyplayer[ i ] = (areas >> i) & 1;
+        }
+    }
+
+    player_areas = areas;
 }
 
 /**
  * \brief Properly set the areabyplayer record
- * \param[in] area_number Area to connect
+ * \param[in] area_number Area the player is in
+ * \note Free when the player stays inside the areas already connected.
  */
 void Areas_Connect (int area_number)
 {
-    memset (areabyplayer, 0, sizeof (areabyplayer));
-    areabyplayer[ area_number ] = true;
-    Areas_RecursiveConnect (area_number);
+    if (! (player_areas & AREA_BIT (area_number))) {
+        Areas_SetPlayerAreas (Areas_Reach (area_number));
+    }
+
+    player_area = area_number;
 }
 
 /**
@@ -88,8 +131,35 @@ void Areas_Connect (int area_number)
 void Areas_Init (int area_number)
 {
     memset (areaconnect, 0, sizeof (areaconnect));
+    memset (area_adjacent, 0, sizeof (area_adjacent));
     memset (areabyplayer, 0, sizeof (areabyplayer));
     areabyplayer[ area_number ] = true;
+    player_areas = AREA_BIT (area_number);
+    player_area = area_number;
+}
+
+/**
+ * \brief Rebuild the connection bitsets from areaconnect
+ * \param[in] area_number Area the player is in
+ * \note Called after areaconnect was restored from a saved game
+ */
+void Areas_Rebuild (int area_number)
+{
+    int i, j;
+
+    for (i = 0 ; i < NUMAREAS ; ++i) {
+        area_adjacent[ i ] = 0;
+
+        for (j = 0 ; j < NUMAREAS ; ++j) {
+            if (areaconnect[ i ][ j ]) {
+                area_adjacent[ i ] |= AREA_BIT (j);
+            }
+        }
+    }
+
+    player_areas = 0;
+    memset (areabyplayer, 0, sizeof (areabyplayer));
+    Areas_Connect (area_number);
 }
 
 /**
@@ -99,9 +169,26 @@ void Areas_Init (int area_number)
  */
 void Areas_Join (int area1, int area2)
 {
+    bool in1, in2;
+
     // FIXME: check for overflow!
     areaconnect[ area1 ][ area2 ]++;
     areaconnect[ area2 ][ area1 ]++;
+
+    if (areaconnect[ area1 ][ area2 ] != 1) {
+        return; // already connected by another door
+    }
+
+    area_adjacent[ area1 ] |= AREA_BIT (area2);
+    area_adjacent[ area2 ] |= AREA_BIT (area1);
+
+    in1 = (player_areas & AREA_BIT (area1)) != 0;
+    in2 = (player_areas & AREA_BIT (area2)) != 0;
+
+    if (in1 != in2) {
+        // the other side was a separate component, merge it in
+        Areas_SetPlayerAreas (player_areas | Areas_Reach (in1 ? area2 : area1));
+    }
 }
 
 /**
@@ -114,4 +201,16 @@ void Areas_Disconnect (int area1, int area2)
     // FIXME: check for underflow!
     areaconnect[ area1 ][ area2 ]--;
     areaconnect[ area2 ][ area1 ]--;
+
+    if (areaconnect[ area1 ][ area2 ]) {
+        return; // another door still connects them
+    }
+
+    area_adjacent[ area1 ] &= ~AREA_BIT (area2);
+    area_adjacent[ area2 ] &= ~AREA_BIT (area1);
+
+    if ((player_areas & AREA_BIT (area1)) && (player_areas & AREA_BIT (area2))) {
+        // the player's component may have split
+        Areas_SetPlayerAreas (Areas_Reach (player_area));
+    }
 }
@@ -30,6 +30,7 @@
 #include "wolf_player.h"
 #include "wolf_local.h"
 #include "wolf_menu.h"
+#include "../sound/soundfx.h"
 
 #define BJRUNSPEED  2048
 #define BJJUMPSPEED 680
@@ -59,7 +60,7 @@ void SpawnBJVictory (void)
 
 
     Player.position.origin[1] += TILE_GLOBAL * 6;
-    Player.position.angle = 3 * M_PI / 2; // Face south
+    Player.position.angle = ANG_270; // Face south
 
     PL_TryMove (&Player, r_world);
 
@@ -95,7 +96,7 @@ void T_BJJump (entity_t *bj)
  */
 void T_BJYell (entity_t *bj)
 {
-    //Sound_StartSound (NULL, 0, CHAN_VOICE, Sound_RegisterSound ("sfx/082.wav"), 1, ATTN_NORM, 0);
+    Sound_StartSound (NULL, 0, CHAN_VOICE, Sound_RegisterSound ("sfx/082.wav"), 1, ATTN_NORM, 0);
 }
 
 /**
@@ -0,0 +1,469 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file wolf_demo.c
+ * \brief Demo recording and playback.
+ */
+
+/*!
+    \note
+
+    Demo layout: a demoheader_t, then one record per tic. A record is a
+    byte of DEMO_* flags followed by the fields that changed since the
+    last tic, in flag order: buttons and impulse as one byte, forward and
+    side move as two bytes, the view angle as the four bytes of its float
+    and the state hash as four bytes. The first tic has every field but
+    the hash. Standing still costs one byte a tic.
+
+    The view angle is kept bit for bit: the simulation rounds it, so
+    anything less would not repeat the game.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "wolf_demo.h"
+#include "wolf_local.h"
+#include "wolf_player.h"
+#include "wolf_snapshot.h"
+
+#include "client.h"
+#include "../util/arena.h"
+#include "../util/com_string.h"
+#include "../util/filesystem.h"
+#include "../util/timer.h"
+
+#define DEMO_MAGIC      0x4D454457  // "WDEM"
+#define DEMO_VERSION    1
+
+#define DEMO_MAX_SIZE   (4 * 1024 * 1024)
+#define DEMO_HASH_TICS  64          // a state hash every this many tics
+
+#define DEMO_BUTTONS    0x01
+#define DEMO_IMPULSE    0x02
+#define DEMO_FORWARD    0x04
+#define DEMO_SIDE       0x08
+#define DEMO_YAW        0x10
+#define DEMO_HASH       0x20
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t episode;
+    uint8_t map;
+    uint8_t skill;
+    uint8_t pad[ 3 ];
+    uint32_t tics;          // records that follow
+    uint32_t size;          // bytes that follow
+
+} demoheader_t;
+
+typedef enum {
+    demo_off,
+    demo_recording,
+    demo_playing
+
+} demostate_t;
+
+static demostate_t demo_state;
+static bool demo_timedemo;
+static demoheader_t demo_header;
+
+static uint8_t *demo_data;
+static uint32_t demo_pos;
+static uint32_t demo_tic;
+
+static char demo_path[ 1024 ];
+
+// fields of the last tic, records only hold what differs
+static usercmd_t demo_cmd;
+static uint32_t demo_yaw;
+
+static uint32_t demo_desyncs;
+static uint64_t demo_start_usec;
+
+static uint8_t demo_snap[ SNAP_MAX_SIZE ];
+
+extern void StartGame (int episode, int mission, int g_skill);
+
+
+/**
+ * \brief Hash the game state.
+ * \return CRC of a snapshot, 0 if there is no level.
+ * \note Two runs that agree on this agree on everything the simulation keeps.
+ */
+uint32_t Demo_StateHash (void)
+{
+    size_t size;
+
+    size = Snap_Capture (demo_snap);
+
+    if (! size) {
+        return 0;
+    }
+
+    return (uint32_t) crc32 (0, demo_snap, (uInt) size);
+}
+
+/**
+ * \brief Is a demo being recorded or played?
+ * \return true if it is, otherwise false.
+ */
+bool Demo_Active (void)
+{
+    return demo_state != demo_off;
+}
+
+/**
+ * \brief Is a demo being played?
+ * \return true if it is, otherwise false.
+ */
+bool Demo_Playing (void)
+{
+    return demo_state == demo_playing;
+}
+
+/**
+ * \brief Is a timedemo being played?
+ * \return true if it is, otherwise false.
+ */
+bool Demo_Timedemo (void)
+{
+    return demo_state == demo_playing && demo_timedemo;
+}
+
+/**
+ * \brief Start a demo on a new game.
+ * \param[in] episode Episode to play.
+ * \param[in] map Map in the episode.
+ * \param[in] skill Skill level.
+ */
+static void Demo_Begin (int episode, int map, int skill)
+{
+    memset (&demo_cmd, 0, sizeof (demo_cmd));
+    demo_yaw = 0;
+    demo_pos = 0;
+    demo_tic = 0;
+    demo_desyncs = 0;
+
+    ClientState.viewangles[ YAW ] = 0;
+
+    StartGame (episode, map, skill);
+
+    demo_start_usec = Sys_Microseconds();
+}
+
+/**
+ * \brief Start a new game and record its input.
+ * \param[in] name Demo name, saved as name.dem in the user directory.
+ * \param[in] episode Episode to play.
+ * \param[in] map Map in the episode.
+ * \param[in] skill Skill level.
+ * \return true if recording started, otherwise false.
+ */
+bool Demo_Record (const char *name, int episode, int map, int skill)
+{
+    static bool stop_at_exit;
+
+    Demo_Stop();
+
+    demo_data = Mem_Alloc (DEMO_MAX_SIZE);
+
+    if (! demo_data) {
+        printf ("[Demo_Record]: out of memory\n");
+        return false;
+    }
+
+    com_snprintf (demo_path, sizeof (demo_path), "%s%c%s.dem", FS_Userdir(), PATH_SEP, name);
+
+    memset (&demo_header, 0, sizeof (demo_header));
+    demo_header.magic = DEMO_MAGIC;
+    demo_header.version = DEMO_VERSION;
+    demo_header.episode = (uint8_t) episode;
+    demo_header.map = (uint8_t) map;
+    demo_header.skill = (uint8_t) skill;
+
+    if (! stop_at_exit) {
+        atexit (Demo_Stop);   // quitting is how most recordings end
+        stop_at_exit = true;
+    }
+
+    demo_state = demo_recording;
+    demo_timedemo = false;
+
+    printf ("Recording demo %s\n", demo_path);
+    Demo_Begin (episode, map, skill);
+
+    return true;
+}
+
+/**
+ * \brief Start a new game driven by a recorded demo.
+ * \param[in] name Demo name, read from name.dem in the user directory.
+ * \param[in] timedemo true to report how fast it played.
+ * \return true if playback started, otherwise false.
+ */
+bool Demo_Play (const char *name, bool timedemo)
+{
+    FILE *f;
+
+    Demo_Stop();
+
+    com_snprintf (demo_path, sizeof (demo_path), "%s%c%s.dem", FS_Userdir(), PATH_SEP, name);
+    f = fopen (demo_path, "rb");
+
+    if (! f) {
+        printf ("[Demo_Play]: Could not open %s\n", demo_path);
+        return false;
+    }
+
+    if (fread (&demo_header, sizeof (demo_header), 1, f) != 1 ||
+            demo_header.magic != DEMO_MAGIC || demo_header.version != DEMO_VERSION ||
+            demo_header.size > DEMO_MAX_SIZE) {
+        printf ("[Demo_Play]: %s is not a demo of this version\n", demo_path);
+        fclose (f);
+        return false;
+    }
+
+    demo_data = Mem_Alloc (demo_header.size + 1);
+
+    if (! demo_data || fread (demo_data, 1, demo_header.size, f) != demo_header.size) {
+        printf ("[Demo_Play]: Could not read %s\n", demo_path);
+        fclose (f);
+        Mem_Free (demo_data);
+        demo_data = NULL;
+        return false;
+    }
+
+    fclose (f);
+
+    demo_state = demo_playing;
+    demo_timedemo = timedemo;
+
+    Demo_Begin (demo_header.episode, demo_header.map, demo_header.skill);
+
+    return true;
+}
+
+/**
+ * \brief Write what changed in ClientState since the last tic.
+ */
+static void Demo_WriteTic (void)
+{
+    uint8_t *p, *flags;
+    uint32_t yaw, hash;
+
+    // flags, buttons, impulse, two shorts, yaw and hash
+    if (demo_pos + 14 > DEMO_MAX_SIZE) {
+        printf ("[Demo_WriteTic]: demo full after %u tics\n", demo_tic);
+        Demo_Stop();
+        return;
+    }
+
+    p = demo_data + demo_pos;
+    flags = p++;
+    *flags = 0;
+
+    memcpy (&yaw, &ClientState.viewangles[ YAW ], sizeof (yaw));
+
+    if (ClientState.cmd.buttons != demo_cmd.buttons || ! demo_tic) {
+        *flags |= DEMO_BUTTONS;
+        *p++ = ClientState.cmd.buttons;
+    }
+
+    if (ClientState.cmd.impulse != demo_cmd.impulse || ! demo_tic) {
+        *flags |= DEMO_IMPULSE;
+        *p++ = ClientState.cmd.impulse;
+    }
+
+    if (ClientState.cmd.forwardmove != demo_cmd.forwardmove || ! demo_tic) {
+        *flags |= DEMO_FORWARD;
+        memcpy (p, &ClientState.cmd.forwardmove, 2);
+        p += 2;
+    }
+
+    if (ClientState.cmd.sidemove != demo_cmd.sidemove || ! demo_tic) {
+        *flags |= DEMO_SIDE;
+        memcpy (p, &ClientState.cmd.sidemove, 2);
+        p += 2;
+    }
+
+    if (yaw != demo_yaw || ! demo_tic) {
+        *flags |= DEMO_YAW;
+        memcpy (p, &yaw, 4);
+        p += 4;
+    }
+
+    if (demo_tic && demo_tic % DEMO_HASH_TICS == 0) {
+        *flags |= DEMO_HASH;
+        hash = Demo_StateHash();
+        memcpy (p, &hash, 4);
+        p += 4;
+    }
+
+    demo_cmd = ClientState.cmd;
+    demo_yaw = yaw;
+
+    demo_pos = (uint32_t) (p - demo_data);
+    demo_tic++;
+}
+
+/**
+ * \brief Read the next tic into ClientState.
+ * \return false at the end of the demo, otherwise true.
+ */
+static bool Demo_ReadTic (void)
+{
+    uint8_t *p, *end, flags;
+    uint32_t hash;
+
+    if (demo_tic >= demo_header.tics || demo_pos >= demo_header.size) {
+        return false;
+    }
+
+    p = demo_data + demo_pos;
+    end = demo_data + demo_header.size;
+    flags = *p++;
+
+    if (end - p < ((flags & DEMO_BUTTONS) ? 1 : 0) + ((flags & DEMO_IMPULSE) ? 1 : 0) +
+            ((flags & DEMO_FORWARD) ? 2 : 0) + ((flags & DEMO_SIDE) ? 2 : 0) +
+            ((flags & DEMO_YAW) ? 4 : 0) + ((flags & DEMO_HASH) ? 4 : 0)) {
+        printf ("[Demo_ReadTic]: demo is cut short at tic %u\n", demo_tic);
+        return false;
+    }
+
+    if (flags & DEMO_BUTTONS) {
+        demo_cmd.buttons = *p++;
+    }
+
+    if (flags & DEMO_IMPULSE) {
+        demo_cmd.impulse = *p++;
+    }
+
+    if (flags & DEMO_FORWARD) {
+        memcpy (&demo_cmd.forwardmove, p, 2);
+        p += 2;
+    }
+
+    if (flags & DEMO_SIDE) {
+        memcpy (&demo_cmd.sidemove, p, 2);
+        p += 2;
+    }
+
+    if (flags & DEMO_YAW) {
+        memcpy (&demo_yaw, p, 4);
+        p += 4;
+    }
+
+    if (flags & DEMO_HASH) {
+        memcpy (&hash, p, 4);
+        p += 4;
+
+        if (hash != Demo_StateHash()) {
+            if (! demo_desyncs) {
+                printf ("[Demo_ReadTic]: demo out of sync at tic %u\n", demo_tic);
+            }
+
+            demo_desyncs++;
+        }
+    }
+
+    ClientState.cmd.buttons = demo_cmd.buttons;
+    ClientState.cmd.impulse = demo_cmd.impulse;
+    ClientState.cmd.forwardmove = demo_cmd.forwardmove;
+    ClientState.cmd.sidemove = demo_cmd.sidemove;
+
+    memcpy (&ClientState.viewangles[ YAW ], &demo_yaw, sizeof (demo_yaw));
+    ClientState.cmd.angles[ YAW ] = ANGLE2SHORT (ClientState.viewangles[ YAW ]);
+
+    demo_pos = (uint32_t) (p - demo_data);
+    demo_tic++;
+
+    return true;
+}
+
+/**
+ * \brief Record or play back the input of this tic.
+ * \note Call after the input is gathered and before the simulation runs. A
+ *       demo ends with the level: deaths and intermissions wait on the wall
+ *       clock, which a demo can not repeat.
+ */
+void Demo_Tic (void)
+{
+    if (demo_state == demo_off) {
+        return;
+    }
+
+    if (Player.playstate != ex_playing) {
+        Demo_Stop();
+        return;
+    }
+
+    if (demo_state == demo_recording) {
+        Demo_WriteTic();
+    } else if (! Demo_ReadTic()) {
+        Demo_Stop();
+    }
+}
+
+/**
+ * \brief Finish a demo: save a recording, report on a playback.
+ */
+void Demo_Stop (void)
+{
+    FILE *f;
+    double seconds;
+    demostate_t state;
+
+    if (demo_state == demo_off) {
+        return;
+    }
+
+    state = demo_state;
+    demo_state = demo_off;   // Demo_Stop is also called at exit
+
+    seconds = (Sys_Microseconds() - demo_start_usec) / 1000000.0;
+
+    printf ("Demo %s: %u tics in %.2f seconds, %.1f tics/sec, state hash %08x\n",
+            demo_path, demo_tic, seconds, seconds > 0 ? demo_tic / seconds : 0.0, Demo_StateHash());
+
+    if (state == demo_recording) {
+        demo_header.tics = demo_tic;
+        demo_header.size = demo_pos;
+
+        f = fopen (demo_path, "wb");
+
+        if (! f || fwrite (&demo_header, sizeof (demo_header), 1, f) != 1 ||
+                fwrite (demo_data, 1, demo_pos, f) != demo_pos) {
+            printf ("[Demo_Stop]: Could not write %s\n", demo_path);
+        }
+
+        if (f) {
+            fclose (f);
+        }
+    } else if (demo_desyncs) {
+        printf ("Demo %s: out of sync at %u of %u hashes\n", demo_path,
+                demo_desyncs, demo_tic / DEMO_HASH_TICS);
+    }
+
+    Mem_Free (demo_data);
+    demo_data = NULL;
+}
@@ -0,0 +1,56 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+ *  wolf_demo.h:   Demo recording and playback.
+ *
+ */
+
+/*
+    Notes:
+    This module is implemented by wolf_demo.c
+
+    A demo is the input of every tic from the start of a level: buttons,
+    movement and view angle. The simulation only depends on that input and
+    on the random number table, which starts at the same place for demos,
+    so playing a demo back repeats the game exactly. A hash of the game
+    state is stored every so often and compared on playback.
+
+    A timedemo plays back as fast as frames can be drawn and reports tics
+    per second, which makes a repeatable benchmark.
+
+*/
+
+#ifndef __WOLF_DEMO_H__
+#define __WOLF_DEMO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+bool Demo_Record (const char *name, int episode, int map, int skill);
+bool Demo_Play (const char *name, bool timedemo);
+void Demo_Tic (void);
+void Demo_Stop (void);
+
+bool Demo_Active (void);
+bool Demo_Playing (void);
+bool Demo_Timedemo (void);
+uint32_t Demo_StateHash (void);
+
+
+#endif /* __WOLF_DEMO_H__ */
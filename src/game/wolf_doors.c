@@ -36,9 +36,11 @@
 #include "wolf_level.h"
 #include "wolf_player.h"
 #include "wolf_local.h"
+#include "../sound/soundfx.h"
 
 #define CLOSEWALL   MINDIST // Space between wall & player
 #define MAXDOORS    64      // max number of sliding doors
+#define DOOR_OPENTICS   (DOOR_TIMEOUT + 1)  // an open door waits DOOR_TIMEOUT whole tics
 
 
 /**
@@ -48,6 +50,11 @@
 void Door_Reset (LevelDoors_t *lvldoors)
 {
     lvldoors->doornum = 0;
+    lvldoors->epoch = 0;
+    lvldoors->numactive = 0;
+    lvldoors->clock = 0;
+
+    memset (lvldoors->wheel, 0, sizeof (lvldoors->wheel));
 
     memset (lvldoors->Doors, 0, sizeof (lvldoors->Doors));
     memset (lvldoors->DoorMap, 0, sizeof (lvldoors->DoorMap));
@@ -63,58 +70,62 @@ void Door_Reset (LevelDoors_t *lvldoors)
  */
 int Door_Spawn (LevelDoors_t *lvldoors, int x, int y, int type)
 {
+    doors_t *door;
+
     if (lvldoors->doornum >= MAXDOORS) {
         printf("[%s]: Too many Doors on level! (%d)\n", "wolf_doors.c", lvldoors->doornum);
         return 0;
     }
 
+    door = &lvldoors->Doors[ lvldoors->doornum ];
+
     switch (type) {
     case 0x5A:
-        lvldoors->DoorMap[ x ][ y ].type    = DOOR_VERT;
-        lvldoors->DoorMap[ x ][ y ].vertical = true;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DDOOR + 1;
+        door->type = DOOR_VERT;
+        door->vertical = true;
+        door->texture = TEX_DDOOR + 1;
         break;
 
     case 0x5B:
-        lvldoors->DoorMap[ x ][ y ].type = DOOR_HORIZ;
-        lvldoors->DoorMap[ x ][ y ].vertical = false;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DDOOR;
+        door->type = DOOR_HORIZ;
+        door->vertical = false;
+        door->texture = TEX_DDOOR;
         break;
 
     case 0x5C:
-        lvldoors->DoorMap[ x ][ y ].type = DOOR_G_VERT;
-        lvldoors->DoorMap[ x ][ y ].vertical = true;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DLOCK;
+        door->type = DOOR_G_VERT;
+        door->vertical = true;
+        door->texture = TEX_DLOCK;
         break;
 
     case 0x5D:
-        lvldoors->DoorMap[ x ][ y ].type = DOOR_G_HORIZ;
-        lvldoors->DoorMap[ x ][ y ].vertical = false;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DLOCK;
+        door->type = DOOR_G_HORIZ;
+        door->vertical = false;
+        door->texture = TEX_DLOCK;
         break;
 
     case 0x5E:
-        lvldoors->DoorMap[ x ][ y ].type = DOOR_S_VERT;
-        lvldoors->DoorMap[ x ][ y ].vertical = true;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DLOCK + 1;
+        door->type = DOOR_S_VERT;
+        door->vertical = true;
+        door->texture = TEX_DLOCK + 1;
         break;
 
     case 0x5F:
-        lvldoors->DoorMap[ x ][ y ].type = DOOR_S_HORIZ;
-        lvldoors->DoorMap[ x ][ y ].vertical = false;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DLOCK + 1;
+        door->type = DOOR_S_HORIZ;
+        door->vertical = false;
+        door->texture = TEX_DLOCK + 1;
         break;
 
     case 0x64:
-        lvldoors->DoorMap[ x ][ y ].type = DOOR_E_VERT;
-        lvldoors->DoorMap[ x ][ y ].vertical = true;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DELEV + 1;
+        door->type = DOOR_E_VERT;
+        door->vertical = true;
+        door->texture = TEX_DELEV + 1;
         break;
 
     case 0x65:
-        lvldoors->DoorMap[ x ][ y ].type = DOOR_E_HORIZ;
-        lvldoors->DoorMap[ x ][ y ].vertical = false;
-        lvldoors->DoorMap[ x ][ y ].texture = TEX_DELEV;
+        door->type = DOOR_E_HORIZ;
+        door->vertical = false;
+        door->texture = TEX_DELEV;
         break;
 
     default:
@@ -122,11 +133,12 @@ int Door_Spawn (LevelDoors_t *lvldoors, int x, int y, int type)
         return 0;
     }
 
-    lvldoors->DoorMap[ x ][ y ].tilex = x;
-    lvldoors->DoorMap[ x ][ y ].tiley = y;
-    lvldoors->DoorMap[ x ][ y ].action = dr_closed;
+    door->tilex = x;
+    door->tiley = y;
+    door->action = dr_closed;
+    door->number = lvldoors->doornum;
 
-    lvldoors->Doors[ lvldoors->doornum ] = &lvldoors->DoorMap[ x ][ y ];
+    lvldoors->DoorMap[ x ][ y ] = lvldoors->doornum;
     lvldoors->doornum++;
 
     return lvldoors->doornum - 1;
@@ -137,20 +149,20 @@ int Door_Spawn (LevelDoors_t *lvldoors, int x, int y, int type)
  * \param[in] lvldoors Level doors structure
  * \param[in] x X position in tile map
  */
-void Door_SetAreas (LevelDoors_t *lvldoors, int (*areas)[64])
+void Door_SetAreas (LevelDoors_t *lvldoors, int8_t (*areas)[64])
 {
     int n, x, y;
 
     for (n = 0 ; n < lvldoors->doornum ; ++n) {
-        x = lvldoors->Doors[ n ]->tilex;
-        y = lvldoors->Doors[ n ]->tiley;
+        x = lvldoors->Doors[ n ].tilex;
+        y = lvldoors->Doors[ n ].tiley;
 
-        if (lvldoors->Doors[ n ]->vertical) {
-            lvldoors->Doors[ n ]->area1 = areas[ x + 1 ][ y ] >= 0 ? areas[ x + 1 ][ y ] : 0;
-            lvldoors->Doors[ n ]->area2 = areas[ x - 1 ][ y ] >= 0 ? areas[ x - 1 ][ y ] : 0;
+        if (lvldoors->Doors[ n ].vertical) {
+            lvldoors->Doors[ n ].area1 = areas[ x + 1 ][ y ] >= 0 ? areas[ x + 1 ][ y ] : 0;
+            lvldoors->Doors[ n ].area2 = areas[ x - 1 ][ y ] >= 0 ? areas[ x - 1 ][ y ] : 0;
         } else {
-            lvldoors->Doors[ n ]->area1 = areas[ x ][ y + 1 ] >= 0 ? areas[ x ][ y + 1 ] : 0;
-            lvldoors->Doors[ n ]->area2 = areas[ x ][ y - 1 ] >= 0 ? areas[ x ][ y - 1 ] : 0;
+            lvldoors->Doors[ n ].area1 = areas[ x ][ y + 1 ] >= 0 ? areas[ x ][ y + 1 ] : 0;
+            lvldoors->Doors[ n ].area2 = areas[ x ][ y - 1 ] >= 0 ? areas[ x ][ y - 1 ] : 0;
         }
     }
 }
@@ -164,7 +176,7 @@ void Door_SetAreas (LevelDoors_t *lvldoors, int (*areas)[64])
  */
 static uint8_t CanCloseDoor (int x, int y, bool vertical)
 {
-    int n;
+    entity_t *ent;
 
     if (POS2TILE (Player.position.origin[ 0 ]) == x &&
             POS2TILE (Player.position.origin[ 1 ]) == y) {
@@ -182,20 +194,18 @@ static uint8_t CanCloseDoor (int x, int y, bool vertical)
             }
         }
 
-        for (n = 0 ; n < NumGuards ; ++n) {
-            if (Guards[ n ].tilex == x && Guards[ n ].tiley == y) {
-                return 0; // guard in door
-            }
+        if (Actor_FirstOnTile (x, y)) {
+            return 0; // guard in door
+        }
 
-            if (Guards[ n ].tilex == x - 1 &&
-                    Guards[ n ].tiley == y &&
-                    POS2TILE (Guards[ n ].x + CLOSEWALL) == x) {
+        for (ent = Actor_FirstOnTile (x - 1, y) ; ent ; ent = Actor_NextOnTile (ent)) {
+            if (POS2TILE (ent->x + CLOSEWALL) == x) {
                 return 0; // guard in door
             }
+        }
 
-            if (Guards[ n ].tilex == x + 1 &&
-                    Guards[ n ].tiley == y &&
-                    POS2TILE (Guards[ n ].x - CLOSEWALL) == x) {
+        for (ent = Actor_FirstOnTile (x + 1, y) ; ent ; ent = Actor_NextOnTile (ent)) {
+            if (POS2TILE (ent->x - CLOSEWALL) == x) {
                 return 0; // guard in door
             }
         }
@@ -210,20 +220,18 @@ static uint8_t CanCloseDoor (int x, int y, bool vertical)
             }
         }
 
-        for (n = 0 ; n < NumGuards ; ++n) {
-            if (Guards[ n ].tilex == x && Guards[ n ].tiley == y) {
-                return 0; // guard in door
-            }
+        if (Actor_FirstOnTile (x, y)) {
+            return 0; // guard in door
+        }
 
-            if (Guards[ n ].tilex == x &&
-                    Guards[ n ].tiley == y - 1 &&
-                    POS2TILE (Guards[ n ].y + CLOSEWALL) == y) {
+        for (ent = Actor_FirstOnTile (x, y - 1) ; ent ; ent = Actor_NextOnTile (ent)) {
+            if (POS2TILE (ent->y + CLOSEWALL) == y) {
                 return 0; // guard in door
             }
+        }
 
-            if (Guards[ n ].tilex == x &&
-                    Guards[ n ].tiley == y + 1 &&
-                    POS2TILE (Guards[ n ].y - CLOSEWALL) == y) {
+        for (ent = Actor_FirstOnTile (x, y + 1) ; ent ; ent = Actor_NextOnTile (ent)) {
+            if (POS2TILE (ent->y - CLOSEWALL) == y) {
                 return 0; // guard in door
             }
         }
@@ -232,6 +240,62 @@ static uint8_t CanCloseDoor (int x, int y, bool vertical)
     return 1;
 }
 
+/**
+ * \brief Put a door in the active list, it moves every tic from now on.
+ * \param[in] lvldoors Level doors structure
+ * \param[in] door Door to activate
+ */
+static void Door_Activate (LevelDoors_t *lvldoors, doors_t *door)
+{
+    if (! door->active) {
+        door->active = true;
+        lvldoors->active[ lvldoors->numactive++ ] = door->number;
+    }
+}
+
+/**
+ * \brief Take an open door off the timer wheel.
+ * \param[in] lvldoors Level doors structure
+ * \param[in] door Door to cancel
+ */
+static void Door_TimerCancel (LevelDoors_t *lvldoors, doors_t *door)
+{
+    uint16_t *link;
+
+    if (! door->timed) {
+        return;
+    }
+
+    link = &lvldoors->wheel[ lvldoors->close_tic[ door->number ] & (DOOR_WHEEL_SIZE - 1) ];
+
+    while (*link != door->number + 1) {
+        link = &lvldoors->wheel_next[ *link - 1 ];
+    }
+
+    *link = lvldoors->wheel_next[ door->number ];
+    door->timed = false;
+}
+
+/**
+ * \brief Make an open door try to close after a delay.
+ * \param[in] lvldoors Level doors structure
+ * \param[in] door Door to time
+ * \param[in] delay Tics from now
+ */
+static void Door_TimerArm (LevelDoors_t *lvldoors, doors_t *door, int delay)
+{
+    uint16_t *slot;
+
+    Door_TimerCancel (lvldoors, door);
+
+    lvldoors->close_tic[ door->number ] = lvldoors->clock + delay;
+    slot = &lvldoors->wheel[ lvldoors->close_tic[ door->number ] & (DOOR_WHEEL_SIZE - 1) ];
+
+    lvldoors->wheel_next[ door->number ] = *slot;
+    *slot = door->number + 1;
+    door->timed = true;
+}
+
 /**
  * \brief Open door
  * \param[in] door Door to open
@@ -239,12 +303,33 @@ static uint8_t CanCloseDoor (int x, int y, bool vertical)
 void Door_Open (doors_t *door)
 {
     if (door->action == dr_open) {
-        door->ticcount = 0;     // reset opened time
+        Door_TimerArm (&r_world->Doors, door, DOOR_OPENTICS); // reset opened time
     } else {
+        if (door->action != dr_opening) {
+            r_world->Doors.epoch++;
+        }
+
         door->action = dr_opening;  // start opening it
+        Door_Activate (&r_world->Doors, door);
     }
 }
 
+/**
+ * \brief Start closing an open door.
+ * \param[in] lvldoors Level doors structure
+ * \param[in] door Door to close
+ */
+static void Door_Close (LevelDoors_t *lvldoors, doors_t *door)
+{
+    Door_TimerCancel (lvldoors, door);
+
+    lvldoors->epoch++;
+    lvldoors->open_epoch++;
+    door->action = dr_closing;
+    door->ticcount = DOOR_FULLOPEN;
+    Door_Activate (lvldoors, door);
+}
+
 /**
  * \brief Change door state
  * \param[in] Door Door state to change
@@ -254,94 +339,129 @@ static void Door_ChangeDoorState (doors_t *Door)
     if (Door->action < dr_opening) {
         Door_Open (Door);
     } else if (Door->action == dr_open && CanCloseDoor (Door->tilex, Door->tiley, Door->vertical)) {
-        Door->action = dr_closing;
-        Door->ticcount = DOOR_FULLOPEN;
+        Door_Close (&r_world->Doors, Door);
+    }
+}
+
+/**
+ * \brief Close the open doors whose time ran out.
+ * \param[in] lvldoors Doors to process
+ * \param[in] tic Door clock tic to expire
+ * \note A blocked door tries again after DOOR_TIMEOUT - DOOR_MINOPEN tics.
+ */
+static void Door_TimerExpire (LevelDoors_t *lvldoors, uint32_t tic)
+{
+    uint16_t *slot = &lvldoors->wheel[ tic & (DOOR_WHEEL_SIZE - 1) ];
+    uint16_t next = *slot;
+    doors_t *door;
+
+    *slot = 0;
+
+    while (next) {
+        door = &lvldoors->Doors[ next - 1 ];
+        next = lvldoors->wheel_next[ door->number ];
+        door->timed = false;
+
+        if (CanCloseDoor (door->tilex, door->tiley, door->vertical)) {
+            Door_Close (lvldoors, door); // Door timeout, time to close it!
+        } else {
+            // If player or something is in door do not close it!
+            Door_TimerArm (lvldoors, door, DOOR_TIMEOUT - DOOR_MINOPEN);
+        }
+    }
+}
+
+/**
+ * \brief Play a sound from a door's tile.
+ * \param[in] door Door
+ * \param[in] name Sound file name.
+ * \note Left out if the door doesn't lead into an area connected to the player's.
+ */
+static void Door_Sound (doors_t *door, const char *name)
+{
+    int32_t origin[ 2 ];
+
+    if (! areabyplayer[ door->area1 ]) {
+        soundfx_stats.culled++;
+        return;
     }
+
+    origin[ 0 ] = TILE2POS (door->tilex);
+    origin[ 1 ] = TILE2POS (door->tiley);
+
+    Sound_StartSound (origin, 1, CHAN_AUTO, Sound_RegisterSound (name), 1, ATTN_STATIC, 0);
 }
 
 /**
  * \brief Doors to process
  * \param[in] lvldoors Doors to process
  * \param[in] t_tk Clock tics
+ * \note Only doors that are moving or whose timer ran out are looked at.
  */
 void Door_Process (LevelDoors_t *lvldoors, int t_tk)
 {
     int n;
+    doors_t *door;
+    uint32_t tic = lvldoors->clock + 1;
 
-    for (n = 0 ; n < lvldoors->doornum ; ++n) {
-        switch (lvldoors->Doors[ n ]->action) {
-        case dr_closed: // this door is closed!
-            continue;
-
-        case dr_opening:
-            if (lvldoors->Doors[ n ]->ticcount >= DOOR_FULLOPEN) { // door fully opened!
-                lvldoors->Doors[ n ]->action = dr_open;
-                lvldoors->Doors[ n ]->ticcount = 0;
+    lvldoors->clock += t_tk;
+
+    for (n = 0 ; n < lvldoors->numactive ; ++n) {
+        door = &lvldoors->Doors[ lvldoors->active[ n ] ];
+        lvldoors->epoch++;
+
+        if (door->action == dr_opening) {
+            if (door->ticcount >= DOOR_FULLOPEN) { // door fully opened!
+                door->action = dr_open;
+                door->ticcount = 0;
+                lvldoors->open_epoch++;
+                Door_TimerArm (lvldoors, door, DOOR_OPENTICS);
             } else { // opening!
-                if (lvldoors->Doors[ n ]->ticcount == 0) {
+                if (door->ticcount == 0) {
                     // door is just starting to open, so connect the areas
-                    Areas_Join (lvldoors->Doors[ n ]->area1, lvldoors->Doors[ n ]->area2);
-                    Areas_Connect (Player.areanumber);
+                    Areas_Join (door->area1, door->area2);
 
-                    if (areabyplayer[ lvldoors->Doors[ n ]->area1 ]) { // Door Opening sound!
-                        //Sound_StartSound (NULL, 1, CHAN_AUTO, Sound_RegisterSound ("sfx/010.wav"), 1, ATTN_STATIC, 0);
-                    }
+                    Door_Sound (door, "sfx/010.wav");   // Door Opening sound!
                 }
 
-                lvldoors->Doors[n]->ticcount += t_tk;
+                door->ticcount += t_tk;
 
-                if (lvldoors->Doors[ n ]->ticcount > DOOR_FULLOPEN) {
-                    lvldoors->Doors[ n ]->ticcount = DOOR_FULLOPEN;
+                if (door->ticcount > DOOR_FULLOPEN) {
+                    door->ticcount = DOOR_FULLOPEN;
                 }
-            }
-
-            break;
 
-        case dr_closing:
-            if (lvldoors->Doors[ n ]->ticcount <= 0) { // door fully closed! disconnect areas!
-                Areas_Disconnect (lvldoors->Doors[ n ]->area1, lvldoors->Doors[ n ]->area2);
-                Areas_Connect (Player.areanumber);
-                lvldoors->Doors[ n ]->ticcount = 0;
-                lvldoors->Doors[ n ]->action = dr_closed;
+                continue;
+            }
+        } else {
+            if (door->ticcount <= 0) { // door fully closed! disconnect areas!
+                Areas_Disconnect (door->area1, door->area2);
+                door->ticcount = 0;
+                door->action = dr_closed;
             } else { // closing!
-                if (lvldoors->Doors[ n ]->ticcount == DOOR_FULLOPEN) {
-                    if (areabyplayer[ lvldoors->Doors[ n ]->area1 ]) { // Door Closing sound!
-                        //Sound_StartSound (NULL, 1, CHAN_AUTO, Sound_RegisterSound ("sfx/007.wav"), 1, ATTN_STATIC, 0);
-                    }
+                if (door->ticcount == DOOR_FULLOPEN) {
+                    Door_Sound (door, "sfx/007.wav");   // Door Closing sound!
                 }
 
-                lvldoors->Doors[ n ]->ticcount -= t_tk;
+                door->ticcount -= t_tk;
 
-                if (lvldoors->Doors[ n ]->ticcount < 0) {
-                    lvldoors->Doors[ n ]->ticcount = 0;
+                if (door->ticcount < 0) {
+                    door->ticcount = 0;
                 }
-            }
-
-            break;
-
-        case dr_open:
-            if (lvldoors->Doors[ n ]->ticcount > DOOR_MINOPEN) {
-                // If player or something is in door do not close it!
-                if (! CanCloseDoor (lvldoors->Doors[ n ]->tilex, lvldoors->Doors[ n ]->tiley, lvldoors->Doors[ n ]->vertical)) {
-                    lvldoors->Doors[ n ]->ticcount = DOOR_MINOPEN; // do not close door immediately!
-                }
-            }
 
-            if (lvldoors->Doors[ n ]->ticcount >= DOOR_TIMEOUT) {
-                // Door timeout, time to close it!
-                lvldoors->Doors[ n ]->action = dr_closing;
-                lvldoors->Doors[ n ]->ticcount = DOOR_FULLOPEN;
-            } else {
-                // Increase timeout!
-                lvldoors->Doors[ n ]->ticcount += t_tk;
+                continue;
             }
+        }
 
-            break;
-
-        } // End switch lvldoors->Doors[ n ].action
-
-    } // End for n = 0 ; n < lvldoors->doornum ; ++n
+        // door came to rest, the last active door takes its place
+        door->active = false;
+        lvldoors->active[ n ] = lvldoors->active[ --lvldoors->numactive ];
+        n--;
+    }
 
+    // doors that start closing now move from the next tic on
+    for ( ; tic <= lvldoors->clock ; ++tic) {
+        Door_TimerExpire (lvldoors, tic);
+    }
 }
 
 /**
@@ -352,11 +472,13 @@ void Door_Process (LevelDoors_t *lvldoors, int t_tk)
  * \return DOOR_FULLOPEN        Door is opened
  *         0                    Door is closed
  *         >0 <DOOR_FULLOPEN    Door is partially opened.
- * \note If there are no doors in tile assume a closed door!
+ * \note Only valid on tiles with DOOR_TILE set.
  */
 int Door_Opened (LevelDoors_t *lvldoors, int x, int y)
 {
-    return lvldoors->DoorMap[ x ][ y ].action == dr_open ? DOOR_FULLOPEN : lvldoors->DoorMap[ x ][ y ].ticcount;
+    doors_t *door = DOOR_AT (lvldoors, x, y);
+
+    return door->action == dr_open ? DOOR_FULLOPEN : door->ticcount;
 }
 
 /**
@@ -0,0 +1,174 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file wolf_flow.c
+ * \brief Distance to the player over walkable tiles.
+ */
+
+/*!
+    \note
+
+    Two fields are kept: one for actors that open doors on their way, where
+    every door counts as walkable, and one for dogs and fakes, where only open
+    doors do. Each is a breadth first walk from the player's tile and is only
+    redone when the player steps onto another tile or the tiles it depends on
+    change: a push-wall for both, a door opening or closing for the second.
+    Actors don't block the field; they are handled by AI_ChangeDir as before.
+
+*/
+
+#include <string.h>
+
+#include "wolf_local.h"
+#include "wolf_level.h"
+#include "wolf_player.h"
+
+#define FLOW_FAR    0xFFFF  // not reachable from the player
+
+typedef struct {
+    bool valid;
+    LevelData_t *lvl;
+    int px, py;
+    bool pw_active;
+    int pw_x, pw_y;
+    uint32_t open_epoch;
+
+} flowkey_t;
+
+static uint16_t flow_dist[ 2 ][ 64 ][ 64 ];    // [ opens doors ][ x ][ y ]
+static flowkey_t flow_key[ 2 ];
+
+uint32_t flow_rebuilds;
+
+/**
+ * \brief Walk the map breadth first from the player's tile.
+ * \param[in] lvl Level structure
+ * \param[in] opens_doors Which field to build.
+ * \param[in] px X position of the player in tile map
+ * \param[in] py Y position of the player in tile map
+ */
+static void Flow_Build (LevelData_t *lvl, bool opens_doors, int px, int py)
+{
+    static bool walkable[ 64 * 64 ];
+    static uint16_t queue[ 64 * 64 ];
+    uint16_t *dist = &flow_dist[ opens_doors ][ 0 ][ 0 ];
+    int head = 0, tail = 0;
+    int n, next;
+    long tile;
+
+    // one straight pass over the tile map, the walk below only reads this
+    for (n = 0 ; n < 64 * 64 ; ++n) {
+        tile = lvl->tilemap[ n >> 6 ][ n & 63 ];
+
+        if (tile & SOLID_TILE) {
+            walkable[ n ] = false;
+        } else if ((tile & DOOR_TILE) && ! opens_doors) {
+            walkable[ n ] = DOOR_AT (&lvl->Doors, n >> 6, n & 63)->action == dr_open;
+        } else {
+            walkable[ n ] = true;
+        }
+
+        dist[ n ] = FLOW_FAR;
+    }
+
+    n = px << 6 | py;
+    dist[ n ] = 0;
+    queue[ tail++ ] = (uint16_t) n;
+
+    while (head < tail) {
+        n = queue[ head++ ];
+
+// tile index is x * 64 + y
+#define FLOW_VISIT( cond, step ) \
+        if ((cond) && dist[ next = n + (step) ] == FLOW_FAR && walkable[ next ]) { \
+            dist[ next ] = dist[ n ] + 1; \
+            queue[ tail++ ] = (uint16_t) next; \
+        }
+
+        FLOW_VISIT ((n >> 6) < 63, 64)   // east
+        FLOW_VISIT ((n & 63) < 63, 1)    // north
+        FLOW_VISIT ((n >> 6) > 0, -64)   // west
+        FLOW_VISIT ((n & 63) > 0, -1)    // south
+
+#undef FLOW_VISIT
+    }
+
+    flow_rebuilds++;
+}
+
+/**
+ * \brief Forget both fields.
+ * \note Call after the tile map was replaced (new level, loaded game).
+ */
+void Flow_Reset (void)
+{
+    memset (flow_key, 0, sizeof (flow_key));
+}
+
+/**
+ * \brief Which way is the player?
+ * \param[in] lvl Level structure
+ * \param[in] tilex X position of the actor in tile map
+ * \param[in] tiley Y position of the actor in tile map
+ * \param[in] opens_doors Set to true if the actor opens doors.
+ * \param[in] away Set to true to get the directions leading away from the player instead.
+ * \return Bit dir4 set for every cardinal neighbour one step nearer to (or further from) the player,
+ *         0 if the actor can't reach the player.
+ */
+int Flow_Gradient (LevelData_t *lvl, int tilex, int tiley, bool opens_doors, bool away)
+{
+    flowkey_t *key = &flow_key[ opens_doors ];
+    uint16_t (*dist)[ 64 ] = flow_dist[ opens_doors ];
+    int px = POS2TILE (Player.position.origin[ 0 ]);
+    int py = POS2TILE (Player.position.origin[ 1 ]);
+    uint32_t open_epoch = opens_doors ? 0 : lvl->Doors.open_epoch;
+    int i, nx, ny, want, mask = 0;
+
+    if (! key->valid || key->lvl != lvl || key->px != px || key->py != py ||
+            key->pw_active != PWall.active || key->pw_x != PWall.x || key->pw_y != PWall.y ||
+            key->open_epoch != open_epoch) {
+        Flow_Build (lvl, opens_doors, px, py);
+
+        key->valid = true;
+        key->lvl = lvl;
+        key->px = px;
+        key->py = py;
+        key->pw_active = PWall.active;
+        key->pw_x = PWall.x;
+        key->pw_y = PWall.y;
+        key->open_epoch = open_epoch;
+    }
+
+    if (dist[ tilex ][ tiley ] == FLOW_FAR) {
+        return 0;
+    }
+
+    want = away ? dist[ tilex ][ tiley ] + 1 : dist[ tilex ][ tiley ] - 1;
+
+    for (i = dir4_east ; i <= dir4_south ; ++i) {
+        nx = tilex + dx4dir[ i ];
+        ny = tiley + dy4dir[ i ];
+
+        if (nx >= 0 && nx < 64 && ny >= 0 && ny < 64 && dist[ nx ][ ny ] == want) {
+            mask |= BIT (i);
+        }
+    }
+
+    return mask;
+}
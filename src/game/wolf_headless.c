@@ -0,0 +1,266 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file wolf_headless.c
+ * \brief Simulation without window, GL or audio.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <SDL2/SDL.h>
+
+#include "wolf_headless.h"
+#include "wolf_local.h"
+#include "wolf_player.h"
+#include "wolf_demo.h"
+
+#include "client.h"
+#include "../util/jobs.h"
+#include "../util/timer.h"
+
+#define BOT_SPEED   4000    // forward move, as cl_forwardspeed
+
+typedef struct {
+    int world;
+    uint32_t tics;
+    uint32_t restarts;
+    uint32_t hash;
+    uint64_t usec;
+
+} headless_result_t;
+
+static uint32_t bot_seed;
+static int32_t bot_x, bot_y;
+
+extern void StartGame (int episode, int mission, int g_skill);
+
+
+/**
+ * \brief Bot random numbers, kept apart from the game's own.
+ * \return Random number between 0 and 255.
+ */
+static int Bot_Rnd (void)
+{
+    bot_seed = bot_seed * 1664525 + 1013904223;
+
+    return bot_seed >> 24;
+}
+
+/**
+ * \brief Make up this tic's input: walk ahead, and when stuck press use
+ *        and turn away. Shoot now and then.
+ */
+static void Bot_Tic (void)
+{
+    memset (&ClientState.cmd, 0, sizeof (ClientState.cmd));
+
+    ClientState.cmd.forwardmove = BOT_SPEED;
+
+    if (Player.position.origin[ 0 ] == bot_x && Player.position.origin[ 1 ] == bot_y) {
+        ClientState.cmd.buttons |= BUTTON_USE;
+        ClientState.viewangles[ YAW ] += ANG_90 + Bot_Rnd() * ANG_180 / 256;
+    }
+
+    if (Bot_Rnd() < 16) {
+        ClientState.cmd.buttons |= BUTTON_ATTACK;
+    }
+
+    ClientState.cmd.angles[ YAW ] = ANGLE2SHORT (ClientState.viewangles[ YAW ]);
+
+    bot_x = Player.position.origin[ 0 ];
+    bot_y = Player.position.origin[ 1 ];
+}
+
+/**
+ * \brief Run one world to the end.
+ * \param[in] world Number of the world, seeds the bot.
+ * \param[in] episode Episode the bot plays.
+ * \param[in] map Map the bot plays.
+ * \param[in] skill Skill the bot plays at.
+ * \param[in] demo Demo to play instead of the bot, or NULL.
+ * \param[in] tics Tics to run, 0 for the whole demo.
+ * \param[out] result Tics run, time taken and the final state hash.
+ * \return false if the world could not start, otherwise true.
+ */
+static bool Headless_World (int world, int episode, int map, int skill, const char *demo,
+                            int tics, headless_result_t *result)
+{
+    uint64_t start;
+
+    memset (result, 0, sizeof (*result));
+    result->world = world;
+
+    bot_seed = world;
+    bot_x = bot_y = 0;
+
+    if (demo) {
+        if (! Demo_Play (demo, true)) {
+            return false;
+        }
+    } else {
+        StartGame (episode, map, skill);
+    }
+
+    if (! r_world) {
+        return false;
+    }
+
+    start = Sys_Microseconds();
+
+    while (! tics || result->tics < (uint32_t) tics) {
+        if (demo) {
+            Demo_Tic();
+
+            if (! Demo_Active()) {
+                break;
+            }
+        } else {
+            if (Player.playstate != ex_playing) {
+                StartGame (episode, map, skill);
+                result->restarts++;
+            }
+
+            Bot_Tic();
+        }
+
+        Player.position.angle = FineNormalize ((int) ClientState.viewangles[ YAW ]);
+
+        frame_think();
+        result->tics++;
+    }
+
+    result->usec = Sys_Microseconds() - start;
+    result->hash = Demo_StateHash();
+
+    Demo_Stop();
+
+    return true;
+}
+
+/**
+ * \brief Print what a world did.
+ */
+static void Headless_Report (const headless_result_t *result)
+{
+    double seconds = result->usec / 1000000.0;
+
+    printf ("world %d: %u tics in %.2f seconds, %.0f tics/sec, %u restarts, state hash %08x\n",
+            result->world, result->tics, seconds, seconds > 0 ? result->tics / seconds : 0.0,
+            result->restarts, result->hash);
+}
+
+/**
+ * \brief Run the simulation as fast as possible, in one or more worlds.
+ * \param[in] episode Episode the bot plays.
+ * \param[in] map Map the bot plays.
+ * \param[in] skill Skill the bot plays at.
+ * \param[in] demo Demo to play instead of the bot, or NULL.
+ * \param[in] tics Tics to run in every world, 0 for the whole demo.
+ * \param[in] worlds Worlds to run in parallel, one process each.
+ * \return Exit status: 0 if every world ran.
+ * \note Nothing but the game logic is initialized.
+ */
+int Headless_Run (int episode, int map, int skill, const char *demo, int tics, int worlds)
+{
+    headless_result_t result;
+    uint64_t start, total;
+    int fds[ 2 ];
+    int w, done, status, failed;
+    pid_t pid;
+
+    if (! demo && tics <= 0) {
+        printf ("[Headless_Run]: the bot needs a tic count\n");
+        return 1;
+    }
+
+    ClientStatic.headless = true;
+    ClientStatic.menuState = IPM_GAME;
+
+    Game_Init();
+
+    if (worlds <= 1) {
+        Jobs_Init (SDL_GetCPUCount() - 1);
+
+        if (! Headless_World (0, episode, map, skill, demo, tics, &result)) {
+            return 1;
+        }
+
+        Headless_Report (&result);
+        return 0;
+    }
+
+    if (pipe (fds) != 0) {
+        printf ("[Headless_Run]: pipe failed\n");
+        return 1;
+    }
+
+    start = Sys_Microseconds();
+
+    for (w = 0 ; w < worlds ; ++w) {
+        pid = fork();
+
+        if (pid < 0) {
+            printf ("[Headless_Run]: could only start %d of %d worlds\n", w, worlds);
+            break;
+        }
+
+        if (pid == 0) {
+            close (fds[ 0 ]);
+
+            // every core already has a world, jobs would only compete
+            if (Headless_World (w, episode, map, skill, demo, tics, &result)) {
+                // less than PIPE_BUF, so results do not interleave
+                if (write (fds[ 1 ], &result, sizeof (result)) != sizeof (result)) {
+                    _exit (1);
+                }
+            }
+
+            _exit (0);
+        }
+    }
+
+    close (fds[ 1 ]);
+
+    total = 0;
+    done = 0;
+
+    while (read (fds[ 0 ], &result, sizeof (result)) == sizeof (result)) {
+        Headless_Report (&result);
+        total += result.tics;
+        done++;
+    }
+
+    close (fds[ 0 ]);
+
+    failed = 0;
+
+    while (wait (&status) > 0) {
+        if (! WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+            failed++;
+        }
+    }
+
+    printf ("%d of %d worlds: %.0f tics/sec together\n", done, worlds,
+            total * 1000000.0 / (Sys_Microseconds() - start));
+
+    return (done == worlds && ! failed) ? 0 : 1;
+}
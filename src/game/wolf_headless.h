@@ -0,0 +1,47 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+ *  wolf_headless.h:   Simulation without window, GL or audio.
+ *
+ */
+
+/*
+    Notes:
+    This module is implemented by wolf_headless.c
+
+    Headless runs only the game logic, tic after tic as fast as the CPU
+    allows, for soak tests and for measuring the AI. The input comes from
+    a demo or from a simple bot that walks, turns when it is stuck, opens
+    doors and shoots now and then. The level is started again whenever
+    the bot dies or leaves it.
+
+    Several worlds run side by side in processes of their own: the game
+    state is global, so one world per process is what keeps them
+    independent. Headless runs repeat the random numbers, so a world
+    reports the same state hash every time it runs the same input.
+
+*/
+
+#ifndef __WOLF_HEADLESS_H__
+#define __WOLF_HEADLESS_H__
+
+int Headless_Run (int episode, int map, int skill, const char *demo, int tics, int worlds);
+
+
+#endif /* __WOLF_HEADLESS_H__ */
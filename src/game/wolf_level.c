@@ -37,9 +37,13 @@
 #include "../util/compression.h"
 
 #include "../util/com_string.h"
+#include "../util/jobs.h"
+#include "../util/arena.h"
 #include "../graphics/texture_manager.h"
+#include "../sound/soundfx.h"
 
 #include "wolf_actors.h"
+#include "client.h"
 
 
 statinfo_t static_wl6[] = {
@@ -117,7 +121,7 @@ void CacheTextures (uint16_t start, uint16_t end)
 {
     uint16_t i;
 
-    if (end < start) {
+    if (end < start || ClientStatic.headless) {
         return;
     }
 
@@ -593,25 +597,25 @@ static void Lvl_SpawnObj (LevelData_t *lvl, int type, int x, int y) {
         case 0x13: // start N
             lvl->pSpawn.origin[0] = TILE2POS (x);
             lvl->pSpawn.origin[1] = TILE2POS (y);
-            lvl->pSpawn.angle = DEG2RAD (90);
+            lvl->pSpawn.angle = ANG_90;
             break;
 
         case 0x14: // start E
             lvl->pSpawn.origin[0] = TILE2POS (x);
             lvl->pSpawn.origin[1] = TILE2POS (y);
-            lvl->pSpawn.angle = DEG2RAD (0);
+            lvl->pSpawn.angle = ANG_0;
             break;
 
         case 0x15: // start S
             lvl->pSpawn.origin[0] = TILE2POS (x);
             lvl->pSpawn.origin[1] = TILE2POS (y);
-            lvl->pSpawn.angle = DEG2RAD (270);
+            lvl->pSpawn.angle = ANG_270;
             break;
 
         case 0x16: // start W
             lvl->pSpawn.origin[0] = TILE2POS (x);
             lvl->pSpawn.origin[1] = TILE2POS (y);
-            lvl->pSpawn.angle = DEG2RAD (180);
+            lvl->pSpawn.angle = ANG_180;
             break;
 
         case 0x5a: // turn E
@@ -663,6 +667,48 @@ static void Lvl_SpawnObj (LevelData_t *lvl, int type, int x, int y) {
 #define MAPHEADER_SIZE  49
 #define MAP_SIGNATURE   0x21444921
 
+/**
+ * \brief Read the music name of a level without loading it.
+ * \param[in] levelname Name of level
+ * \param[out] music Music file name.
+ * \param[in] size Size of music in bytes.
+ * \return false if the level can't be read.
+ * \note Used to prefetch the next level's music during the intermission.
+ */
+bool Level_PeekMusicName (const char *levelname, char *music, size_t size)
+{
+    uint32_t signature;
+    uint16_t mapNameLength, musicNameLength;
+    filehandle_t *fhandle;
+    bool ok;
+
+    fhandle = FS_OpenFile (levelname);
+
+    if (! fhandle) {
+        return false;
+    }
+
+    FS_ReadFile (&signature, 1, 4, fhandle);
+
+    // name lengths follow rle, size, ceiling, floor and the three planes
+    FS_FileSeek (fhandle, 36, SEEK_SET);
+    FS_ReadFile (&mapNameLength, 1, 2, fhandle);
+    FS_ReadFile (&musicNameLength, 1, 2, fhandle);
+
+    ok = signature == MAP_SIGNATURE && musicNameLength < size &&
+         FS_GetFileSize (fhandle) >= MAPHEADER_SIZE + mapNameLength + musicNameLength;
+
+    if (ok) {
+        FS_FileSeek (fhandle, MAPHEADER_SIZE + mapNameLength, SEEK_SET);
+        FS_ReadFile (music, 1, musicNameLength, fhandle);
+        music[ musicNameLength ] = '\0';
+    }
+
+    FS_CloseFile (fhandle);
+
+    return ok;
+}
+
 
 /**
  * \brief Load level
@@ -686,6 +732,7 @@ LevelData_t *Level_LoadMap (const char *levelname)
     uint16_t musicNameLength;
     char *musicName;
     int32_t filesize;
+    size_t mark;
 
     int x, y0, y, layer1, layer2;
 
@@ -742,8 +789,13 @@ LevelData_t *Level_LoadMap (const char *levelname)
         return NULL;
     }
 
-    mapName = (char *)malloc (mapNameLength + 1);
-    musicName = (char *)malloc (musicNameLength + 1);
+    mapName = (char *)Arena_Alloc (&level_arena, mapNameLength + 1);
+    musicName = (char *)Arena_Alloc (&level_arena, musicNameLength + 1);
+
+    if (! mapName || ! musicName) {
+        FS_CloseFile (fhandle);
+        return NULL;
+    }
 
 
     FS_ReadFile (mapName, 1, mapNameLength, fhandle);
@@ -761,56 +813,86 @@ LevelData_t *Level_LoadMap (const char *levelname)
 //
 // Plane1  -Walls
 //
-    data = (uint8_t*)malloc (length[ 0 ]);
+    mark = Arena_Mark (&frame_arena);
+    data = (uint8_t*)Arena_Alloc (&frame_arena, length[ 0 ]);
+
+    if (! data) {
+        FS_CloseFile (fhandle);
+        return NULL;
+    }
 
     FS_FileSeek (fhandle, offset[ 0 ], SEEK_SET);
     FS_ReadFile (data, 1, length[ 0 ], fhandle);
 
 
     expanded = * ((unsigned short *)data);
-    buffer = (uint16_t*)malloc (expanded);
+    buffer = (uint16_t*)Arena_Alloc (&frame_arena, expanded);
+
+    if (! buffer) {
+        FS_CloseFile (fhandle);
+        return NULL;
+    }
 
     Lvl_CarmackExpand ((unsigned short *)data + 1, buffer, expanded);
     Lvl_RLEWexpand (buffer + 1, newMap->Plane1, 64 * 64 * 2, rle);
 
-    free (buffer);
-    free (data);
+    Arena_Release (&frame_arena, mark);
 
 //
 // Plane2 -Objects
 //
-    data = (uint8_t*)malloc (length[ 1 ]);
+    mark = Arena_Mark (&frame_arena);
+    data = (uint8_t*)Arena_Alloc (&frame_arena, length[ 1 ]);
+
+    if (! data) {
+        FS_CloseFile (fhandle);
+        return NULL;
+    }
 
     FS_FileSeek (fhandle, offset[ 1 ], SEEK_SET);
     FS_ReadFile (data, 1, length[ 1 ], fhandle);
 
 
     expanded = * ((uint16_t*)data);
-    buffer = (uint16_t*)malloc (expanded);
+    buffer = (uint16_t*)Arena_Alloc (&frame_arena, expanded);
+
+    if (! buffer) {
+        FS_CloseFile (fhandle);
+        return NULL;
+    }
 
     Lvl_CarmackExpand ((uint16_t*)data + 1, buffer, expanded);
     Lvl_RLEWexpand (buffer + 1, newMap->Plane2, 64 * 64 * 2, rle);
 
-    free (buffer);
-    free (data);
+    Arena_Release (&frame_arena, mark);
 
 //
 // Plane3 -Other
 //
-    data = (uint8_t*)malloc (length[ 2 ]);
+    mark = Arena_Mark (&frame_arena);
+    data = (uint8_t*)Arena_Alloc (&frame_arena, length[ 2 ]);
+
+    if (! data) {
+        FS_CloseFile (fhandle);
+        return NULL;
+    }
 
     FS_FileSeek (fhandle, offset[ 2 ], SEEK_SET);
     FS_ReadFile (data, 1, length[ 2 ], fhandle);
 
 
     expanded = * ((uint16_t*)data);
-    buffer = (uint16_t*)malloc (expanded);
+    buffer = (uint16_t*)Arena_Alloc (&frame_arena, expanded);
+
+    if (! buffer) {
+        FS_CloseFile (fhandle);
+        return NULL;
+    }
 
     Lvl_CarmackExpand ((uint16_t*)data + 1, buffer, expanded);
     Lvl_RLEWexpand (buffer + 1, newMap->Plane3, 64 * 64 * 2, rle);
 
-    free (buffer);
-    free (data);
+    Arena_Release (&frame_arena, mark);
 
 
     FS_CloseFile (fhandle);
@@ -887,6 +969,8 @@ LevelData_t *Level_LoadMap (const char *levelname)
     }
 
     Door_SetAreas (&newMap->Doors, newMap->areas);
+    Level_LOSReset (newMap);
+    Flow_Reset();
 
     strncpy(levelstate.level_name, mapName, sizeof(levelstate.level_name));
 
@@ -953,10 +1037,14 @@ void Level_PrecacheTextures_Sound (LevelData_t *lvl)
 
     com_snprintf (texname, sizeof (texname), "pics/FACE8APIC.tga");
     texture_get_picture(texname);
+
+    // Sounds, decoded once for every level
+    Sound_Precache ("sfx", 120);
+    Sound_Precache ("lsfx", 88);
 }
 
 /**
- * \brief Check level line
+ * \brief Trace a line through the tile map.
  * \param[in] x1 X-Coordinate of first point
  * \param[in] y1 Y-Coordinate of first point
  * \param[in] x2 X-Coordinate of second point
@@ -964,7 +1052,7 @@ void Level_PrecacheTextures_Sound (LevelData_t *lvl)
  * \param[in] lvl Level structure
  * return true if a straight line between 2 points is unobstructed, otherwise false.
  */
-bool Level_CheckLine (int32_t x1, int32_t y1, int32_t x2, int32_t y2, LevelData_t *lvl)
+static bool Level_TraceLine (int32_t x1, int32_t y1, int32_t x2, int32_t y2, LevelData_t *lvl)
 {
     int32_t xt1, yt1, xt2, yt2; /* tile positions */
     int32_t x, y;              /* current point in !tiles! */
@@ -1025,15 +1113,15 @@ bool Level_CheckLine (int32_t x1, int32_t y1, int32_t x2, int32_t y2, LevelData_
 
             if (lvl->tilemap[ x ][ y ] & DOOR_TILE) {
                 // door, see if the door is open enough
-                if (lvl->Doors.DoorMap[ x ][ y ].action != dr_open) {
-                    if (lvl->Doors.DoorMap[ x ][ y ].action == dr_closed) {
+                if (DOOR_AT (&lvl->Doors, x, y)->action != dr_open) {
+                    if (DOOR_AT (&lvl->Doors, x, y)->action == dr_closed) {
                         return false;
                     }
 
                     // checking vertical doors in action: ->_I_
                     intercept = ((Frac - ystep / 2) & 0xFF) >> 4; // 1/64 of tile
 
-                    if (intercept < (63 - lvl->Doors.DoorMap[ x ][ y ].ticcount)) {
+                    if (intercept < (63 - DOOR_AT (&lvl->Doors, x, y)->ticcount)) {
                         return false;
                     }
                 }
@@ -1072,15 +1160,15 @@ bool Level_CheckLine (int32_t x1, int32_t y1, int32_t x2, int32_t y2, LevelData_
 
             if (lvl->tilemap[ x ][ y ] & DOOR_TILE) {
                 // door, see if the door is open enough
-                if (lvl->Doors.DoorMap[ x ][ y ].action != dr_open) {
-                    if (lvl->Doors.DoorMap[ x ][ y ].action == dr_closed) {
+                if (DOOR_AT (&lvl->Doors, x, y)->action != dr_open) {
+                    if (DOOR_AT (&lvl->Doors, x, y)->action == dr_closed) {
                         return false;
                     }
 
                     // checking vertical doors in action: ->_I_
                     intercept = ((Frac - xstep / 2) & 0xFF) >> 4; // 1/64 of tile
 
-                    if (intercept < lvl->Doors.DoorMap[ x ][ y ].ticcount) {
+                    if (intercept < DOOR_AT (&lvl->Doors, x, y)->ticcount) {
                         return false;
                     }
                 }
@@ -1093,3 +1181,260 @@ bool Level_CheckLine (int32_t x1, int32_t y1, int32_t x2, int32_t y2, LevelData_
 
     return true;
 }
+
+/*
+-----------------------------------------------------------------------------
+    Line of sight cache
+
+    Level_TraceLine only looks at the points in 1/256 tile units, so a result
+    keyed on those coordinates stays exact for as long as no wall or door
+    changes. Doors bump LevelDoors_t.epoch, push-walls are tracked by their
+    position; either one starts a new LOS epoch and drops every entry.
+-----------------------------------------------------------------------------
+*/
+
+#define LOS_CACHE_BITS  10
+#define LOS_CACHE_SIZE  (1 << LOS_CACHE_BITS)
+
+typedef struct {
+    uint64_t key;
+    uint32_t epoch;     // entry is valid only if it matches los_epoch
+    bool visible;
+} los_entry_t;
+
+level_los_stats_t level_los_stats;
+
+static los_entry_t los_cache[ LOS_CACHE_SIZE ];
+static uint32_t los_epoch = 1;
+
+// state the cache was filled under
+static LevelData_t *los_lvl;
+static uint32_t los_door_epoch;
+static bool los_pw_active;
+static int los_pw_x, los_pw_y;
+
+// static table: summed count of tiles that may ever block a line,
+// los_solid[ x ][ y ] covers tiles [0, x) x [0, y)
+static uint16_t los_solid[ 65 ][ 65 ];
+
+/**
+ * \brief Build the static visibility table from the tile map.
+ * \param[in] lvl Level structure
+ * \note Walls and doors in any state count as blocking.
+ */
+static void Level_LOSBuildStatic (LevelData_t *lvl)
+{
+    int x, y;
+
+    memset (los_solid, 0, sizeof (los_solid));
+
+    for (x = 0 ; x < 64 ; ++x) {
+        for (y = 0 ; y < 64 ; ++y) {
+            los_solid[ x + 1 ][ y + 1 ] = los_solid[ x ][ y + 1 ] + los_solid[ x + 1 ][ y ] - los_solid[ x ][ y ] +
+                                          ((lvl->tilemap[ x ][ y ] & (WALL_TILE | DOOR_TILE)) ? 1 : 0);
+        }
+    }
+}
+
+/**
+ * \brief Is the line statically unobstructed?
+ * \return true if no tile the trace can touch may block it.
+ * \note The tile box is grown by one to cover the tracer's rounding.
+ */
+static bool Level_LOSStaticClear (int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    int minx, maxx, miny, maxy;
+
+    if (x1 < x2) {
+        minx = POS2TILE (x1) - 1;
+        maxx = POS2TILE (x2) + 2;
+    } else {
+        minx = POS2TILE (x2) - 1;
+        maxx = POS2TILE (x1) + 2;
+    }
+
+    if (y1 < y2) {
+        miny = POS2TILE (y1) - 1;
+        maxy = POS2TILE (y2) + 2;
+    } else {
+        miny = POS2TILE (y2) - 1;
+        maxy = POS2TILE (y1) + 2;
+    }
+
+    if (minx < 0) {
+        minx = 0;
+    }
+
+    if (miny < 0) {
+        miny = 0;
+    }
+
+    if (maxx > 64) {
+        maxx = 64;
+    }
+
+    if (maxy > 64) {
+        maxy = 64;
+    }
+
+    return los_solid[ maxx ][ maxy ] - los_solid[ minx ][ maxy ] - los_solid[ maxx ][ miny ] + los_solid[ minx ][ miny ] == 0;
+}
+
+/**
+ * \brief Drop cached lines and rebuild the static table.
+ * \param[in] lvl Level structure
+ * \note Call after the tile map was replaced (new level, loaded game).
+ */
+void Level_LOSReset (LevelData_t *lvl)
+{
+    los_epoch++;
+    los_lvl = lvl;
+    los_door_epoch = lvl->Doors.epoch;
+    los_pw_active = PWall.active;
+    los_pw_x = PWall.x;
+    los_pw_y = PWall.y;
+
+    Level_LOSBuildStatic (lvl);
+}
+
+/**
+ * \brief Start a new LOS epoch if a door or push-wall changed since the last check.
+ * \param[in] lvl Level structure
+ */
+static void Level_LOSSync (LevelData_t *lvl)
+{
+    if (lvl != los_lvl || PWall.active != los_pw_active || PWall.x != los_pw_x || PWall.y != los_pw_y) {
+        Level_LOSReset (lvl);  // walls moved
+    } else if (lvl->Doors.epoch != los_door_epoch) {
+        los_epoch++;
+        los_door_epoch = lvl->Doors.epoch;
+    }
+}
+
+/**
+ * \brief Cache slot for a line.
+ * \param[out] key Cache key of the line.
+ */
+static los_entry_t *Level_LOSEntry (int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint64_t *key)
+{
+    // 14 bits per coordinate at 1/256 tile precision
+    *key = ((uint64_t) (x1 >> 8) << 42) | ((uint64_t) (y1 >> 8) << 28) |
+           ((uint64_t) (x2 >> 8) << 14) | (uint64_t) (y2 >> 8);
+
+    return &los_cache[ (*key * 0x9E3779B97F4A7C15ULL) >> (64 - LOS_CACHE_BITS) ];
+}
+
+/**
+ * \brief Check level line
+ * \param[in] x1 X-Coordinate of first point
+ * \param[in] y1 Y-Coordinate of first point
+ * \param[in] x2 X-Coordinate of second point
+ * \param[in] y2 Y-Coordinate of second point
+ * \param[in] lvl Level structure
+ * return true if a straight line between 2 points is unobstructed, otherwise false.
+ */
+bool Level_CheckLine (int32_t x1, int32_t y1, int32_t x2, int32_t y2, LevelData_t *lvl)
+{
+    los_entry_t *entry;
+    uint64_t key;
+
+    level_los_stats.calls++;
+
+    Level_LOSSync (lvl);
+
+    entry = Level_LOSEntry (x1, y1, x2, y2, &key);
+
+    if (entry->epoch == los_epoch && entry->key == key) {
+        level_los_stats.hits++;
+        return entry->visible;
+    }
+
+    if (Level_LOSStaticClear (x1, y1, x2, y2)) {
+        level_los_stats.static_hits++;
+        return true;
+    }
+
+    entry->key = key;
+    entry->epoch = los_epoch;
+    entry->visible = Level_TraceLine (x1, y1, x2, y2, lvl);
+
+    return entry->visible;
+}
+
+/*
+-----------------------------------------------------------------------------
+    Sensing ahead
+
+    Level_CheckLines traces a batch of lines on the worker threads and puts
+    the results into the LOS cache under the current epoch. Level_TraceLine
+    only reads the tile map and the doors, and nothing else runs while the
+    batch does, so the workers need no locking. A later Level_CheckLine
+    takes a result only while its epoch is still current: once a door or
+    push-wall moved in between it traces again, so callers see exactly what
+    they would have without the batch.
+-----------------------------------------------------------------------------
+*/
+
+typedef struct {
+    LevelData_t *lvl;
+    los_query_t *lines[ LOS_CACHE_SIZE ];
+
+} los_batch_t;
+
+static los_batch_t los_batch;
+
+/**
+ * \brief Trace one line of the batch.
+ * \note Runs on any thread, writes only to its own query.
+ */
+static void Level_TraceJob (int index, void *data)
+{
+    los_batch_t *batch = data;
+    los_query_t *q = batch->lines[ index ];
+
+    q->visible = Level_TraceLine (q->x1, q->y1, q->x2, q->y2, batch->lvl);
+}
+
+/**
+ * \brief Check many level lines at once.
+ * \param[in/out] queries Lines to check, visible is filled in.
+ * \param[in] count Number of lines.
+ * \param[in] lvl Level structure
+ * \note Lines that would miss the cache are traced on the worker threads, then cached.
+ */
+void Level_CheckLines (los_query_t *queries, int count, LevelData_t *lvl)
+{
+    los_entry_t *entry;
+    los_query_t *q;
+    uint64_t key;
+    int i, n = 0;
+
+    Level_LOSSync (lvl);
+
+    for (i = 0 ; i < count ; ++i) {
+        q = &queries[ i ];
+        entry = Level_LOSEntry (q->x1, q->y1, q->x2, q->y2, &key);
+
+        if (entry->epoch == los_epoch && entry->key == key) {
+            q->visible = entry->visible;
+        } else if (Level_LOSStaticClear (q->x1, q->y1, q->x2, q->y2)) {
+            q->visible = true;
+        } else if (n < LOS_CACHE_SIZE) {
+            los_batch.lines[ n++ ] = q;
+        } else {
+            q->visible = Level_TraceLine (q->x1, q->y1, q->x2, q->y2, lvl);
+        }
+    }
+
+    los_batch.lvl = lvl;
+    Jobs_ParallelFor (n, Level_TraceJob, &los_batch);
+    level_los_stats.sensed += n;
+
+    for (i = 0 ; i < n ; ++i) {
+        q = los_batch.lines[ i ];
+        entry = Level_LOSEntry (q->x1, q->y1, q->x2, q->y2, &key);
+        entry->key = key;
+        entry->epoch = los_epoch;
+        entry->visible = q->visible;
+    }
+}
@@ -76,6 +76,8 @@
 
 #define DOOR_FULLOPEN   63
 
+#define DOOR_WHEEL_SIZE 512     // timer wheel slots, must be a power of two > DOOR_TIMEOUT
+
 
 #define DOOR_VERT       255
 #define DOOR_HORIZ      254
@@ -148,13 +150,16 @@ typedef enum {
 } dr_state;
 
 typedef struct {
-    int tilex, tiley;
+    uint8_t tilex, tiley;
     bool vertical;
+    bool active;        // in LevelDoors_t.active
+    bool timed;         // waiting on the timer wheel to close
+    uint8_t number;     // index in LevelDoors_t.Doors
+    int8_t area1, area2;
     int ticcount;
 
     dr_state action;
 
-    int area1, area2;
     /*DOOR_VERT         255
         DOOR_HORIZ      254
         DOOR_E_VERT     253
@@ -163,18 +168,32 @@ typedef struct {
         DOOR_G_HORIZ    250
         DOOR_S_VERT     249
         DOOR_S_HORIZ    248*/
-    int type;
+    uint8_t type;
 
-    int texture;
+    uint16_t texture;
 
 }  doors_t;
 
 typedef struct {
     int doornum;
-    doors_t *Doors[ 256 ];
-    doors_t DoorMap[ 64 ][ 64 ];
+    uint8_t DoorMap[ 64 ][ 64 ];    // door number, only meaningful on DOOR_TILE tiles
+    doors_t Doors[ MAX_DOORS ];
+    uint32_t epoch; // bumped whenever a door changes (see R_RayCast, Level_CheckLine)
+    uint32_t open_epoch; // bumped when a door reaches or leaves dr_open (see Flow_Gradient)
+
+    uint8_t active[ MAX_DOORS ];    // numbers of the doors opening or closing
+    int numactive;
+
+    // open doors by the tic they try to close; door number + 1, 0 ends a list
+    uint16_t wheel[ DOOR_WHEEL_SIZE ];
+    uint16_t wheel_next[ MAX_DOORS ];
+    uint32_t close_tic[ MAX_DOORS ];
+    uint32_t clock;                 // tics run by Door_Process
 } LevelDoors_t;
 
+// door on tile x, y; the tile must have DOOR_TILE set
+#define DOOR_AT( lvldoors, x, y )   ( &(lvldoors)->Doors[ (lvldoors)->DoorMap[ (x) ][ (y) ] ] )
+
 #define MAX_POWERUPS 1000
 
 ///////////////////
@@ -183,24 +202,20 @@ typedef struct {
 //
 ///////////////////
 typedef struct {
-    char fname[ 32 ]; /* Map filename */
-
-    uint16_t Plane1[ 64 * 64 ]; /* walls */
-    uint16_t Plane2[ 64 * 64 ]; /* objects */
-    uint16_t Plane3[ 64 * 64 ]; /* other */
+    // read by every trace and move, keep together
+    uint32_t tilemap[ 64 ][ 64 ];   // wall values only
 
-    long tilemap[ 64 ][ 64 ];   // wall values only
-      // this is an array of references to texture descriptions
-// the renderer must know what to draw by this number
-    int wall_tex_x[ 64 ][ 64 ]; // x_wall
-    int wall_tex_y[ 64 ][ 64 ]; // y_wall
+    LevelDoors_t Doors;
 
 // this is a (0-based) array of area numbers!
 // must be all filled by level loading sub
 // if -1 it is a wall, if -2 it is a door, if -3 it is unknown
-    int areas[ 64 ][ 64 ];
+    int8_t areas[ 64 ][ 64 ];
 
-    LevelDoors_t Doors;
+      // this is an array of references to texture descriptions
+// the renderer must know what to draw by this number
+    uint16_t wall_tex_x[ 64 ][ 64 ]; // x_wall
+    uint16_t wall_tex_y[ 64 ][ 64 ]; // y_wall
 
     placeonplane_t pSpawn; // player spawn place
 
@@ -210,12 +225,19 @@ typedef struct {
     sprite_t        sprites[ MAX_SPRITES ];
     int             numSprites;
 
-    char mapName[128];      /* Map name */
-    char musicName[128];    /* Music file name */
+    uint8_t tileEverVisible[ 64 ][ 64 ]; // for automap
 
     colour3_t ceilingColour, floorColour;
 
-    uint8_t tileEverVisible[ 64 ][ 64 ]; // for automap
+    // only needed while loading
+    char fname[ 32 ]; /* Map filename */
+
+    uint16_t Plane1[ 64 * 64 ]; /* walls */
+    uint16_t Plane2[ 64 * 64 ]; /* objects */
+    uint16_t Plane3[ 64 * 64 ]; /* other */
+
+    char mapName[128];      /* Map name */
+    char musicName[128];    /* Music file name */
 } LevelData_t;
 
 
@@ -230,8 +252,27 @@ extern LevelData_t *r_world;
 extern LevelData_t  levelData;
 
 LevelData_t *Level_LoadMap (const char *levelname);
+bool Level_PeekMusicName (const char *levelname, char *music, size_t size);
 void Level_PrecacheTextures_Sound (LevelData_t *lvl);
 bool Level_CheckLine (int32_t x1, int32_t y1, int32_t x2, int32_t y2, LevelData_t *lvl);
+void Level_LOSReset (LevelData_t *lvl);
+
+typedef struct {
+    int32_t x1, y1, x2, y2;
+    bool visible;
+
+} los_query_t;
+
+void Level_CheckLines (los_query_t *queries, int count, LevelData_t *lvl);
+
+typedef struct {
+    uint32_t calls;
+    uint32_t hits;          // answered from the LOS cache
+    uint32_t static_hits;   // answered by the static table, no trace needed
+    uint32_t sensed;        // traced ahead by Level_CheckLines
+} level_los_stats_t;
+
+extern level_los_stats_t level_los_stats;  // cleared every tic
 void Level_ScanInfoPlane (LevelData_t *lvl);
 
 ///////////////////
@@ -241,7 +282,7 @@ void Level_ScanInfoPlane (LevelData_t *lvl);
 ///////////////////
 void Door_Reset (LevelDoors_t *lvl);
 int Door_Spawn (LevelDoors_t *lvl, int x, int y, int type);
-void Door_SetAreas (LevelDoors_t *lvl, int (*areas)[64]);
+void Door_SetAreas (LevelDoors_t *lvl, int8_t (*areas)[64]);
 void Door_Open (doors_t *door);
 void Door_Process (LevelDoors_t *lvl, int t_tk);
 int Door_Opened (LevelDoors_t *lvl, int x, int y);
@@ -256,6 +297,7 @@ extern  bool    areabyplayer[ NUMAREAS ];
 
 void Areas_Init (int areanumber);
 void Areas_Connect (int areanumber);
+void Areas_Rebuild (int areanumber);
 void Areas_Join (int area1, int area2);
 void Areas_Disconnect (int area1, int area2);
 
@@ -282,4 +324,15 @@ bool PushWall_Push (int x, int y, dir4type dir);
 void PushWall_Process (void);
 
 
+///////////////////
+//
+//  Flow field
+//
+///////////////////
+extern uint32_t flow_rebuilds;  // fields rebuilt since the level started
+
+void Flow_Reset (void);
+int Flow_Gradient (LevelData_t *lvl, int tilex, int tiley, bool opens_doors, bool away);
+
+
 #endif /* __WOLF_LEVEL_H__ */
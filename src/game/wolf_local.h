@@ -91,6 +91,8 @@ typedef struct {
     uint32_t total_monsters;
     uint32_t killed_monsters;
 
+    uint8_t rndindex;   // position in the random number table, see US_RndT
+
 
 } level_locals_t;
 
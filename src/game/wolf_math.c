@@ -36,6 +36,7 @@
 #include <stdlib.h>
 
 #include "wolf_math.h"
+#include "wolf_local.h"
 
 
 char dx4dir[5] = {1, 0, -1,  0, 0}; // dx & dy based on direction
@@ -65,22 +66,70 @@ int dir8angle[9] = {ANG_0, ANG_45, ANG_90, ANG_135, ANG_180, ANG_225, ANG_270, A
 int dir4angle[5] = {ANG_0, ANG_90, ANG_180, ANG_270, ANG_0};
 
 
+#define ATAN_BITS   12
+#define ATAN_SLOTS  (1 << ATAN_BITS)
+
+static int32_t fine_sine[ ANG_90 + 1 ];        // sin of [0, 90] degrees, 16.16
+static uint16_t fine_atan[ ATAN_SLOTS + 1 ];    // atan of [0, 1] in FINE angles
+
+// Wolfenstein 3-D's random number table
+static const uint8_t rndtable[ 256 ] = {
+      0,   8, 109, 220, 222, 241, 149, 107,  75, 248, 254, 140,  16,  66,  74,  21,
+    211,  47,  80, 242, 154,  27, 205, 128, 161,  89,  77,  36,  95, 110,  85,  48,
+    212, 140, 211, 249,  22,  79, 200,  50,  28, 188,  52, 140, 202, 120,  68, 145,
+     62,  70, 184, 190,  91, 197, 152, 224, 149, 104,  25, 178, 252, 182, 202, 182,
+    141, 197,   4,  81, 181, 242, 145,  42,  39, 227, 156, 198, 225, 193, 219,  93,
+    122, 175, 249,   0, 175, 143,  70, 239,  46, 246, 163,  53, 163, 109, 168, 135,
+      2, 235,  25,  92,  20, 145, 138,  77,  69, 166,  78, 176, 173, 212, 166, 113,
+     94, 161,  41,  50, 239,  49, 111, 164,  70,  60,   2,  37, 171,  75, 136, 156,
+     11,  56,  42, 146, 138, 229,  73, 146,  77,  61,  98, 196, 135, 106,  63, 197,
+    195,  86,  96, 203, 113, 101, 170, 247, 181, 113,  80, 250, 108,   7, 255, 237,
+    129, 226,  79, 107, 112, 166, 103, 241,  24, 223, 239, 120, 198,  58,  60,  82,
+    128,   3, 184,  66, 143, 224, 145, 224,  81, 206, 163,  45,  63,  90, 168, 114,
+     59,  33, 159,  95,  28, 139, 123,  98, 125, 196,  15,  70, 194, 253,  54,  14,
+    109, 226,  71,  17, 161,  93, 186,  87, 244, 138,  20,  52, 123, 251,  26,  36,
+     17,  46,  52, 231, 232,  76,  31, 221,  84,  37, 216, 165, 212, 106, 197, 242,
+     98,  43,  39, 175, 254, 145, 190,  84, 118, 222, 187, 136, 120, 163, 236, 249
+};
+
 /**
  * \brief Intialize wolf math module.
+ * \note Table entries are rounded to whole units, so the few libm ulps that
+ *       differ between compilers and flags never reach the game.
  */
 int WM_BuildTables (void)
 {
-    srand ((unsigned int)time (NULL));
+    const double pi = 3.14159265358979323846;
+    int i;
+
+    for (i = 0 ; i <= ANG_90 ; ++i) {
+        fine_sine[ i ] = (int32_t) floor (sin (i * pi / ANG_180) * FIXED_ONE + 0.5);
+    }
+
+    for (i = 0 ; i <= ATAN_SLOTS ; ++i) {
+        fine_atan[ i ] = (uint16_t) floor (atan ((double) i / ATAN_SLOTS) * ANG_180 / pi + 0.5);
+    }
+
     return 1;
 }
 
 /**
- * \brief Generates a random number between 1 and 255
- * \return A value between 1 and 255.
+ * \brief Start the random numbers of a level.
+ * \param[in] randomize false to start at the beginning of the table, as demos do.
+ */
+void US_InitRndT (bool randomize)
+{
+    levelstate.rndindex = randomize ? (uint8_t) time (NULL) : 0;
+}
+
+/**
+ * \brief Generates a random number between 0 and 255
+ * \return The next value of the random number table.
+ * \note The position in the table is part of levelstate, so saves, snapshots and demos repeat it.
  */
 int US_RndT (void)
 {
-    return (1 + (rand() % 255)) & 0xFF;
+    return rndtable[ ++levelstate.rndindex ];
 }
 
 /**
@@ -103,20 +152,113 @@ quadrant GetQuadrant (float angle)
     }
 }
 
+/**
+ * \brief Bring an angle into range.
+ * \param[in] angle FINE angle, any value.
+ * \return Angle in [0, ANG_360).
+ */
+int FineNormalize (int angle)
+{
+    angle %= ANG_360;
+
+    if (angle < 0) {
+        angle += ANG_360;
+    }
+
+    return angle;
+}
+
+/**
+ * \brief Smallest difference between two angles.
+ * \param[in] angle1 FINE angle.
+ * \param[in] angle2 FINE angle.
+ * \return Difference in [0, ANG_180].
+ */
+int FineDiff (int angle1, int angle2)
+{
+    int d = FineNormalize (angle1 - angle2);
+
+    return d > ANG_180 ? ANG_360 - d : d;
+}
+
+/**
+ * \brief Sine
+ * \param[in] angle FINE angle.
+ * \return Sine in 16.16 fixed point.
+ */
+int32_t FixedSin (int angle)
+{
+    angle = FineNormalize (angle);
+
+    if (angle < ANG_90) {
+        return fine_sine[ angle ];
+    } else if (angle < ANG_180) {
+        return fine_sine[ ANG_180 - angle ];
+    } else if (angle < ANG_270) {
+        return -fine_sine[ angle - ANG_180 ];
+    } else {
+        return -fine_sine[ ANG_360 - angle ];
+    }
+}
+
+/**
+ * \brief Cosine
+ * \param[in] angle FINE angle.
+ * \return Cosine in 16.16 fixed point.
+ */
+int32_t FixedCos (int angle)
+{
+    return FixedSin (angle + ANG_90);
+}
+
+/**
+ * \brief Angle of a vector.
+ * \param[in] dy Y component.
+ * \param[in] dx X component.
+ * \return FINE angle in [0, ANG_360), 0 for the null vector.
+ */
+int FineAtan2 (int32_t dy, int32_t dx)
+{
+    uint32_t ax = ABS (dx);
+    uint32_t ay = ABS (dy);
+    int angle;
+
+    if (! ax && ! ay) {
+        return 0;
+    }
+
+    // fold into the first octant, rounding to the nearest table slot
+    if (ay <= ax) {
+        angle = fine_atan[ (((uint64_t) ay << ATAN_BITS) + ax / 2) / ax ];
+    } else {
+        angle = ANG_90 - fine_atan[ (((uint64_t) ax << ATAN_BITS) + ay / 2) / ay ];
+    }
+
+    if (dx < 0) {
+        angle = ANG_180 - angle;
+    }
+
+    if (dy < 0) {
+        angle = ANG_360 - angle;
+    }
+
+    return angle == ANG_360 ? 0 : angle;
+}
+
 /**
  * \brief Get the cardinal direction of angle
- * \param[in] angle Angle in radians.
+ * \param[in] angle FINE angle.
  * \return dir4type direction
  */
-dir4type Get4dir (float angle)
+dir4type Get4dir (int angle)
 {
-    angle = angle_normalize (angle + M_PI / 4);
+    angle = FineNormalize (angle + ANG_45);
 
-    if (angle < M_PI / 2) {
+    if (angle < ANG_90) {
         return dir4_east;
-    } else if (angle < M_PI) {
+    } else if (angle < ANG_180) {
         return dir4_north;
-    } else if (angle < 3 * M_PI / 2) {
+    } else if (angle < ANG_270) {
         return dir4_west;
     } else {
         return dir4_south;
@@ -125,26 +267,26 @@ dir4type Get4dir (float angle)
 
 /**
  * \brief Get ordinal direction of angle
- * \param[in] angle Angle in radians.
+ * \param[in] angle FINE angle.
  * \return dir8type direction
  */
-dir8type Get8dir (float angle)
+dir8type Get8dir (int angle)
 {
-    angle = angle_normalize (angle + M_PI / 12);
+    angle = FineNormalize (angle + ANG_180 / 12);
 
-    if (angle <= (M_PI / 4)) {
+    if (angle <= ANG_45) {
         return dir8_east;
-    } else if (angle < (M_PI / 2)) {
+    } else if (angle < ANG_90) {
         return dir8_northeast;
-    } else if (angle <= (3 * M_PI / 4)) {
+    } else if (angle <= ANG_135) {
         return dir8_north;
-    } else if (angle < M_PI) {
+    } else if (angle < ANG_180) {
         return dir8_northwest;
-    } else if (angle <= (5 * M_PI / 4)) {
+    } else if (angle <= ANG_225) {
         return dir8_west;
-    } else if (angle < (3 * M_PI / 2)) {
+    } else if (angle < ANG_270) {
         return dir8_southwest;
-    } else if (angle <= (7 * M_PI / 4)) {
+    } else if (angle <= ANG_315) {
         return dir8_south;
     } else {
         return dir8_southeast;
@@ -155,12 +297,12 @@ dir8type Get8dir (float angle)
  * \brief Calculates distance between a point (x, y) and a line.
  * \param[in] x X-Coordinate.
  * \param[in] y Y-Coordinate.
- * \param[in] angle Angle in radians.
+ * \param[in] angle FINE angle.
  * \return Returns distance between the point and line
  */
-int Point2LineDist (const int x, const int y, const float angle)
+int Point2LineDist (const int x, const int y, const int angle)
 {
-    return ABS ((int) (x * sin (angle) - y * cos (angle)));
+    return ABS ((int) (((int64_t) x * FixedSin (angle) - (int64_t) y * FixedCos (angle)) >> FIXED_SHIFT));
 }
 
 
@@ -168,12 +310,12 @@ int Point2LineDist (const int x, const int y, const float angle)
  * \brief Calculates line length to the point nearest to (point)
  * \param[in] x X-Coordinate.
  * \param[in] y Y-Coordinate.
- * \param[in] angle Angle in radians.
+ * \param[in] angle FINE angle.
  * \return Returns length of line segment
  */
-int LineLen2Point (const int x, const int y, const float angle)
+int LineLen2Point (const int x, const int y, const int angle)
 {
-    return (int) (cos (angle) * x + sin (angle) * y);
+    return (int) (((int64_t) x * FixedCos (angle) + (int64_t) y * FixedSin (angle)) >> FIXED_SHIFT);
 }
 
 /**
@@ -182,7 +324,7 @@ int LineLen2Point (const int x, const int y, const float angle)
  * \param[in] Point1Y Y-Coordinate.
  * \param[in] Point2X X-Coordinate.
  * \param[in] Point2Y Y-Coordinate.
- * \return Returns angle in radians
+ * \return Returns FINE angle
  * \note
  *      point2 = {x,y}
  *            / |
@@ -191,7 +333,7 @@ int LineLen2Point (const int x, const int y, const float angle)
  *      /a______|----------> x
  *  point1 = {x, y}
  */
-float TransformPoint (const double Point1X, const double Point1Y, const double Point2X, const double Point2Y)
+int TransformPoint (const int32_t Point1X, const int32_t Point1Y, const int32_t Point2X, const int32_t Point2Y)
 {
-    return (float)angle_normalize ((float)atan2 (Point1Y - Point2Y, Point1X - Point2X));
-}
\ No newline at end of file
+    return FineAtan2 (Point1Y - Point2Y, Point1X - Point2X);
+}
@@ -40,6 +40,7 @@
 #define __WOLF_MATH_H__
 
 #include <math.h>
+#include <stdbool.h>
 
 #include "../util/com_math.h"
 
@@ -64,7 +65,7 @@ extern int dir8angle[9], dir4angle[5];
 
 typedef struct {
     long origin[2];
-    float angle; //in radians
+    int angle; // FINE angle
     float pitch;
 
 } placeonplane_t;
@@ -83,25 +84,41 @@ typedef struct {
 #define ANG_225     28800   //(int)((float)225/ASTEP)
 #define ANG_270     34560     //(int)((float)270/ASTEP)
 #define ANG_315     40320     //(int)((float)225/ASTEP)
+#define ANG_360     46080
+#define ANG_1       128     // one degree
 // ------------------------- * ^^^ FINE angles ^^^ * -------------------------
 
+// renderer boundary only, game code stays in FINE angles
 #define FINE2RAD( a ) (((a) * M_PI ) / ANG_180)
 #define RAD2FINE( a ) (((a) * ANG_180) / M_PI)
 
+// 16.16 fixed point, same scale as map positions
+#define FIXED_SHIFT 16
+#define FIXED_ONE   (1 << FIXED_SHIFT)
+
+#define FixedMul( a, b )    ( (int32_t)(((int64_t)(a) * (b)) >> FIXED_SHIFT) )
+
 int WM_BuildTables (void);
 
 #define TanDgr( x )     (tan( DEG2RAD( x ) ))
 
+void US_InitRndT (bool randomize);
 int US_RndT (void);
 
-int Point2LineDist (const int x, const int y, const float angle);
-int LineLen2Point (const int x, const int y, const float angle);
+int FineNormalize (int angle);
+int FineDiff (int angle1, int angle2);
+int32_t FixedSin (int angle);
+int32_t FixedCos (int angle);
+int FineAtan2 (int32_t dy, int32_t dx);
+
+int Point2LineDist (const int x, const int y, const int angle);
+int LineLen2Point (const int x, const int y, const int angle);
 
 quadrant GetQuadrant (float angle);
-dir4type Get4dir (float angle);
-dir8type Get8dir (float angle);
+dir4type Get4dir (int angle);
+dir8type Get8dir (int angle);
 
-float TransformPoint (const double Point1X, const double Point1Y, const double Point2X, const double Point2Y);
+int TransformPoint (const int32_t Point1X, const int32_t Point1Y, const int32_t Point2X, const int32_t Point2Y);
 
 
 #endif /* __WOLF_MATH_H__ */
@@ -36,12 +36,15 @@
 
 #include "wolf_local.h"
 #include "wolf_player.h"
+#include "wolf_level.h"
 #include "../graphics/wolf_renderer.h"
 
 #include "client.h"
 #include "../util/com_string.h"
 #include "../graphics/renderer.h"
 #include "../input/keycodes.h"
+#include "../sound/soundfx.h"
+#include "../sound/music.h"
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -192,15 +195,12 @@ static void M_Intermission_Draw (void)
     R_DrawHUD();
 }
 
-extern void Client_PrepRefresh (const char *r_mapname);
-static const char *M_Intermission_Key (int key)
+/**
+ * \brief Which level follows the current one?
+ * \return Level number, -1 if there is no secret level to go to.
+ */
+static int M_NextLevel (void)
 {
-    char szTextMsg[ 128 ];
-
-    PL_NextLevel (&Player);
-
-    M_ForceMenuOff();
-
     int currentLevel = currentMap.episode * 10 + currentMap.map;
     int nextLevel;
 
@@ -231,8 +231,7 @@ static const char *M_Intermission_Key (int key)
                 break;
 
             default:
-                ClientStatic.key_dest = key_console;
-                return NULL;
+                return -1;
         }
     } else {
         switch (currentLevel) {
@@ -266,6 +265,27 @@ static const char *M_Intermission_Key (int key)
                 break;
         }
     }
+
+    return nextLevel;
+}
+
+extern void Client_PrepRefresh (const char *r_mapname);
+static const char *M_Intermission_Key (int key)
+{
+    char szTextMsg[ 128 ];
+    int nextLevel;
+
+    PL_NextLevel (&Player);
+
+    M_ForceMenuOff();
+
+    nextLevel = M_NextLevel();
+
+    if (nextLevel < 0) {
+        ClientStatic.key_dest = key_console;
+        return NULL;
+    }
+
     com_snprintf (szTextMsg, sizeof (szTextMsg),
                   "map w%.2d.map", nextLevel);
 
@@ -496,10 +516,20 @@ static const char *M_Victory_Key (int key)
 
 void M_Intermission_f (void)
 {
-    //Sound_StopAllSounds();
-   // Sound_StopBGTrack();
+    char levelname[ 32 ];
+    char musicname[ 128 ];
+    int nextLevel = M_NextLevel();
+
+    Sound_StopAllSounds();
 
-    //Sound_StartBGTrack ("music/ENDLEVEL.ogg", "music/ENDLEVEL.ogg");
+    music_play ("music/ENDLEVEL.ogg");
+
+    // decode the next level's music while the player reads the ratios
+    com_snprintf (levelname, sizeof (levelname), "maps/w%.2d.map", nextLevel);
+
+    if (nextLevel >= 0 && Level_PeekMusicName (levelname, musicname, sizeof (musicname))) {
+        music_prefetch (musicname);
+    }
 
     bgive_bonus = false;
 
@@ -518,7 +548,7 @@ void M_Intermission_f (void)
 
 
     if (strstr (levelstate.level_name, "Boss") != NULL) {
-        //Sound_StartBGTrack ("music/URAHERO.ogg", "music/URAHERO.ogg");
+        music_play ("music/URAHERO.ogg");
         M_PushMenu (M_Victory_Draw, M_Victory_Key);
     } else if (currentMap.map == 9) {
         PL_GivePoints (&Player, 15000);
@@ -85,11 +85,7 @@ static void MenuDrawNewGameImages (void)
     for (i = 0; i < 6; ++i) {
         com_snprintf (buffer, sizeof (buffer),  "pics/C_EPISODE%dPIC.tga",  i + 1);
 
-        glColor3f (2.0f, 2.0f, 2.0f);
-
         R_Draw_Pic (((viddef.width - 616) >> 1) + 69, 70 + i * 60, buffer);
-
-        glColor3f (1.0f, 1.0f, 1.0f);
     }
 }
 
@@ -39,6 +39,7 @@
 #include "../graphics/wolf_renderer.h"
 #include "wolf_bj.h"
 #include "client.h"
+#include "../sound/soundfx.h"
 
 player_t Player; // player struct (pos, health etc...)
 
@@ -83,6 +84,16 @@ void player_update_movement(void)
     ClientState.cmd.forwardmove = mv_y;
     ClientState.viewangles[YAW] += mv_yaw;
     ClientState.cmd.angles[YAW] = ANGLE2SHORT (ClientState.viewangles[YAW]);
+
+    ClientState.cmd.buttons = 0;
+
+    if (ClientStatic.player.is_attacking) {
+        ClientState.cmd.buttons |= BUTTON_ATTACK;
+    }
+
+    if (ClientStatic.player.is_using) {
+        ClientState.cmd.buttons |= BUTTON_USE;
+    }
 }
 
 /**
@@ -130,7 +141,7 @@ static bool PL_Use (player_t *self, LevelData_t *lvl)
     y = self->tiley + dy4dir[ dir ];
 
     if (lvl->tilemap[ x ][ y ] & DOOR_TILE) {
-        Door_Use (&lvl->Doors.DoorMap[ x ][ y ], Player.items);
+        Door_Use (DOOR_AT (&lvl->Doors, x, y), Player.items);
         return true;
     }
 
@@ -159,7 +170,7 @@ static bool PL_Use (player_t *self, LevelData_t *lvl)
             elevatorSwitchTime = ClientStatic.realtime;
         }
 
-        //Sound_StartSound (NULL, 0, CHAN_BODY, Sound_RegisterSound ("lsfx/040.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_BODY, Sound_RegisterSound ("lsfx/040.wav"), 1, ATTN_NORM, 0);
 
         return true;
     }
@@ -184,7 +195,8 @@ static bool PL_Use (player_t *self, LevelData_t *lvl)
 bool PL_TryMove (player_t *self, LevelData_t *lvl)
 {
     int xl, yl, xh, yh, x, y;
-    int d, n;
+    int d;
+    entity_t *ent;
 
     xl = POS2TILE (Player.position.origin[ 0 ] - PLAYERSIZE);
     yl = POS2TILE (Player.position.origin[ 1 ] - PLAYERSIZE);
@@ -203,22 +215,31 @@ bool PL_TryMove (player_t *self, LevelData_t *lvl)
         }
 
 // check for actors
-    for (n = 0 ; n < NumGuards ; ++n) {
-        if (Guards[ n ].state >= st_die1)
-            continue;
+// an actor's tile leads its position by up to one tile while it walks
+    xl = POS2TILE (self->position.origin[ 0 ] - MINACTORDIST) - 1;
+    yl = POS2TILE (self->position.origin[ 1 ] - MINACTORDIST) - 1;
+    xh = POS2TILE (self->position.origin[ 0 ] + MINACTORDIST) + 1;
+    yh = POS2TILE (self->position.origin[ 1 ] + MINACTORDIST) + 1;
+
+    for (y = yl ; y <= yh ; ++y)
+        for (x = xl ; x <= xh ; ++x) {
+            for (ent = Actor_FirstOnTile (x, y) ; ent ; ent = Actor_NextOnTile (ent)) {
+                if (ent->state >= st_die1)
+                    continue;
 
-        d = self->position.origin[ 0 ] - Guards[ n ].x;
+                d = self->position.origin[ 0 ] - ent->x;
 
-        if (d < -MINACTORDIST || d > MINACTORDIST)
-            continue;
+                if (d < -MINACTORDIST || d > MINACTORDIST)
+                    continue;
 
-        d = self->position.origin[ 1 ] - Guards[ n ].y;
+                d = self->position.origin[ 1 ] - ent->y;
 
-        if (d < -MINACTORDIST || d > MINACTORDIST)
-            continue;
+                if (d < -MINACTORDIST || d > MINACTORDIST)
+                    continue;
 
-        return false;
-    }
+                return false;
+            }
+        }
 
     return true;
 }
@@ -278,7 +299,7 @@ static void PL_ClipMove (player_t *self, int xmove, int ymove)
 static void PL_ControlMovement (player_t *self, LevelData_t *lvl)
 {
     int speed;
-    float angle;
+    int angle;
 
 // rotation
     angle = self->position.angle;
@@ -288,14 +309,14 @@ static void PL_ControlMovement (player_t *self, LevelData_t *lvl)
 
     if (ClientState.cmd.forwardmove) {
         speed = tics * ClientState.cmd.forwardmove;
-        self->movx += (int) (speed * cos (angle));
-        self->movy += (int) (speed * sin (angle));
+        self->movx += FixedMul (speed, FixedCos (angle));
+        self->movy += FixedMul (speed, FixedSin (angle));
     }
 
     if (ClientState.cmd.sidemove) {
         speed = tics * ClientState.cmd.sidemove;
-        self->movx += (int) (speed * sin (angle));
-        self->movy -= (int) (speed * cos (angle));
+        self->movx += FixedMul (speed, FixedSin (angle));
+        self->movy -= FixedMul (speed, FixedCos (angle));
     }
 
     if (!self->movx && !self->movy)
@@ -414,9 +435,9 @@ void PL_Process (player_t *self, LevelData_t *lvl)
     PL_ControlMovement (self, lvl);
 
     if (self->flags & PL_FLAG_ATTCK) {
-        PL_PlayerAttack (self, ClientStatic.player.is_attacking);
+        PL_PlayerAttack (self, ClientState.cmd.buttons & BUTTON_ATTACK);
     } else {
-        if (ClientStatic.player.is_using) {
+        if (ClientState.cmd.buttons & BUTTON_USE) {
             if (! (self->flags & PL_FLAG_REUSE) && PL_Use (self, lvl)) {
                 self->flags |= PL_FLAG_REUSE;
             }
@@ -424,7 +445,7 @@ void PL_Process (player_t *self, LevelData_t *lvl)
             self->flags &= ~PL_FLAG_REUSE;
         }
 
-        if (ClientStatic.player.is_attacking) {
+        if (ClientState.cmd.buttons & BUTTON_ATTACK) {
             self->flags |= PL_FLAG_ATTCK;
 
             self->attackframe = 0;
@@ -466,6 +487,35 @@ void PL_Process (player_t *self, LevelData_t *lvl)
 
 }
 
+/**
+ * \brief Animate BJ's face on the heads-up-display
+ * \param[in] self Player
+ * \note Runs once a tic rather than once a frame, it draws random numbers.
+ */
+void PL_UpdateFace (player_t *self)
+{
+    self->facecount += tics;
+
+    if ((self->face_gotgun || self->face_ouch) && self->facecount > 0) {
+        // gotgun/ouch will set facecount to a negative number initially, go back
+        // to normal face with random look after expired.
+        self->face_gotgun = false;
+        self->face_ouch = false;
+    }
+
+    if (self->facecount > US_RndT()) {
+        self->face_gotgun = false;
+        self->face_ouch = false;
+        self->faceframe = US_RndT() >> 6;
+
+        if (self->faceframe == 3) {
+            self->faceframe = 0;
+        }
+
+        self->facecount = 0;
+    }
+}
+
 /**
  * \brief Reset player data structure
  */
@@ -497,7 +547,7 @@ void PL_Spawn (placeonplane_t location, LevelData_t *lvl)
 
     Areas_Connect (Player.areanumber);
 
-    ClientState.viewangles[ YAW ] = RAD2FINE (location.angle);
+    ClientState.viewangles[ YAW ] = location.angle;
     ClientState.viewangles[ PITCH ] = 0;
 
     Player.playstate = ex_playing;
@@ -528,7 +578,11 @@ void player_take_damage(player_t *self, entity_t *attacker, int points)
         return;
     }
 
-    self->LastAttacker = attacker;
+    self->LastAttacker = Actor_Handle (attacker);
+
+    if (attacker) {
+        self->LastAttackerType = attacker->type;
+    }
 
     if (self->flags & FL_GODMODE/* || gamestate.victoryflag FIXME*/) {
         return;
@@ -543,7 +597,7 @@ void player_take_damage(player_t *self, entity_t *attacker, int points)
     if (self->health <= 0) {
         self->health = 0;
         self->playstate = ex_dead;
-        //Sound_StartSound (NULL, 0, CHAN_BODY, Sound_RegisterSound ("lsfx/009.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_BODY, Sound_RegisterSound ("lsfx/009.wav"), 1, ATTN_NORM, 0);
     }
 
     R_DamageFlash (points);
@@ -653,7 +707,7 @@ void PL_GiveLife (player_t *self)
         self->lives++;
     }
 
-    //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/044.wav"), 1, ATTN_NORM, 0);
+    Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/044.wav"), 1, ATTN_NORM, 0);
 }
 
 /**
@@ -133,7 +133,8 @@ typedef struct player_s {
     int areanumber;
 
     bool madenoise; // FIXME: move to flags?
-    entity_t *LastAttacker;
+    actorhandle_t LastAttacker;
+    enemy_t LastAttackerType;   // still known after the attacker is removed (needles are)
     int faceframe, facecount;   // bj's face in the HUD // FIXME decide something!
     bool face_gotgun, face_ouch;
     state_t playstate; // fixme: move to gamestate
@@ -151,6 +152,7 @@ void player_update_movement(void);
 void PL_Spawn (placeonplane_t location, LevelData_t *lvl);
 
 void PL_Process (player_t *self, LevelData_t *lvl);
+void PL_UpdateFace (player_t *self);
 
 void player_take_damage(player_t *self, entity_t *attacker, int points);
 bool PL_GiveHealth (player_t *self, int points, int max);
@@ -34,6 +34,7 @@
 #include "wolf_powerups.h"
 #include "wolf_player.h"
 #include "wolf_local.h"
+#include "../sound/soundfx.h"
 
 int Pow_Texture[ pow_last ] = {
     SPR_STAT_34,    // pow_gibs
@@ -99,14 +100,14 @@ static int Pow_Give (pow_t type)
     case pow_key2:
         type -= pow_key1;
         PL_GiveKey (&Player, type);
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/012.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/012.wav"), 1, ATTN_NORM, 0);
         break;
 //
 // Treasure
 //
     case pow_cross:
         PL_GivePoints (&Player, 100);
-       // Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/035.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/035.wav"), 1, ATTN_NORM, 0);
 
         if (++levelstate.found_treasure == levelstate.total_treasure) {
         }
@@ -114,7 +115,7 @@ static int Pow_Give (pow_t type)
 
     case pow_chalice:
         PL_GivePoints (&Player, 500);
-       // Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/036.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/036.wav"), 1, ATTN_NORM, 0);
 
         if (++levelstate.found_treasure == levelstate.total_treasure) {
         }
@@ -122,7 +123,7 @@ static int Pow_Give (pow_t type)
 
     case pow_bible:
         PL_GivePoints (&Player, 1000);
-       // Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/037.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/037.wav"), 1, ATTN_NORM, 0);
 
         if (++levelstate.found_treasure == levelstate.total_treasure) {
         }
@@ -130,7 +131,7 @@ static int Pow_Give (pow_t type)
 
     case pow_crown:
         PL_GivePoints (&Player, 5000);
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/045.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/045.wav"), 1, ATTN_NORM, 0);
 
         if (++levelstate.found_treasure == levelstate.total_treasure) {
         }
@@ -144,7 +145,7 @@ static int Pow_Give (pow_t type)
             return 0;
         }
 
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/061.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/061.wav"), 1, ATTN_NORM, 0);
         break;
 
     case pow_alpo:
@@ -152,7 +153,7 @@ static int Pow_Give (pow_t type)
             return 0;
         }
 
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/033.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/033.wav"), 1, ATTN_NORM, 0);
         break;
 
     case pow_food:
@@ -160,7 +161,7 @@ static int Pow_Give (pow_t type)
             return 0;
         }
 
-       // Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/033.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/033.wav"), 1, ATTN_NORM, 0);
         break;
 
     case pow_firstaid:
@@ -168,7 +169,7 @@ static int Pow_Give (pow_t type)
             return 0;
         }
 
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/034.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/034.wav"), 1, ATTN_NORM, 0);
         break;
 
 //
@@ -179,7 +180,7 @@ static int Pow_Give (pow_t type)
             return 0;
         }
 
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/031.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/031.wav"), 1, ATTN_NORM, 0);
         break;
 
     case pow_clip2:
@@ -187,7 +188,7 @@ static int Pow_Give (pow_t type)
             return 0;
         }
 
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/031.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/031.wav"), 1, ATTN_NORM, 0);
         break;
 
     case pow_25clip:
@@ -196,18 +197,18 @@ static int Pow_Give (pow_t type)
         }
 
 //          Sound_StartSound( NULL, 0, CHAN_ITEM, Sound_RegisterSound( "lsfx/064.wav" ), 1, ATTN_NORM, 0 ); //gsh, I don't like this sound
-       // Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/031.wav"), 1, ATTN_NORM, 0);   //gsh, I like this sound
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/031.wav"), 1, ATTN_NORM, 0);   //gsh, I like this sound
         break;
 
     case pow_machinegun:
         PL_GiveWeapon (&Player, WEAPON_MACHINEGUN);
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/030.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/030.wav"), 1, ATTN_NORM, 0);
 
         break;
 
     case pow_gatlinggun:
         PL_GiveWeapon (&Player, WEAPON_GATLINGGUN);
-        //Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/038.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/038.wav"), 1, ATTN_NORM, 0);
 
 
         Player.facecount = -100;
@@ -225,7 +226,7 @@ static int Pow_Give (pow_t type)
         } else {
         }
 
-       // Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/034.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_ITEM, Sound_RegisterSound ("lsfx/034.wav"), 1, ATTN_NORM, 0);
         break;
 
     default:
@@ -40,6 +40,8 @@
 #ifndef __WOLF_POWERUPS_H__
 #define __WOLF_POWERUPS_H__
 
+#include <stdint.h>
+
 typedef enum {
 //please provide description
     pow_gibs,           //  1% if <=10%; SLURPIESND
@@ -64,9 +66,9 @@ typedef enum {
 } pow_t;
 
 typedef struct powerup_s {
-    int x, y;
-    pow_t type;
-    int sprite;
+    int8_t x, y;        // tile, -1 if the slot is free
+    uint8_t type;       // pow_t
+    int16_t sprite;
 } powerup_t;
 
 void Powerup_Reset (void);
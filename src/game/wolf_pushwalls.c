@@ -33,6 +33,7 @@
 
 #include "wolf_local.h"
 #include "wolf_level.h"
+#include "../sound/soundfx.h"
 
 Pwall_t PWall;
 
@@ -55,6 +56,7 @@ void PushWall_Reset (void)
 bool PushWall_Push (int x, int y, dir4type dir)
 {
     int dx, dy;
+    int32_t origin[ 2 ];
 
 
     if (PWall.active) {
@@ -77,7 +79,9 @@ bool PushWall_Push (int x, int y, dir4type dir)
 
     levelstate.found_secrets++;
 
-    //Sound_StartSound (NULL, 1, CHAN_AUTO, Sound_RegisterSound ("sfx/034.wav"), 1, ATTN_STATIC, 0);
+    origin[ 0 ] = TILE2POS (x);
+    origin[ 1 ] = TILE2POS (y);
+    Sound_StartSound (origin, 1, CHAN_AUTO, Sound_RegisterSound ("sfx/034.wav"), 1, ATTN_STATIC, 0);
 
 // good way to avoid stuckness; [un]comment one more down!
 // it makes a tile behind pushwall unpassable
@@ -38,30 +38,173 @@
 uint8_t tile_visible[ 64 ][ 64 ]; // can player see this tile?
 
 
+#define MAX_VIS_FACES   8192    // wall/door faces remembered between frames
+
+/**
+ * \brief Face drawn by the last ray cast, replayed while the view stays put.
+ */
+typedef struct {
+    float x, y;
+    int type;       // dir4type of a wall, -1 for a door
+    int tex;
+
+    bool vertical, backside;    // doors only
+    int amount;                 // doors only
+} r_face_t;
+
+/**
+ * \brief Everything the visible set depends on.
+ */
+typedef struct {
+    bool valid;
+    LevelData_t *lvl;
+    long origin[ 2 ];
+    int angle;
+    float fov;
+    uint32_t door_epoch;
+    bool pw_active;
+    int pw_x, pw_y, pw_moved;
+} r_viskey_t;
+
+static r_face_t vis_faces[ MAX_VIS_FACES ];
+static int num_vis_faces;
+static r_viskey_t vis_key;
+
+r_viscache_stats_t r_viscache_stats;
+
+
+/**
+ * \brief Forget the cached visible set.
+ * \note Call whenever the map changes behind the door / push-wall epoch's back (level load, saved game load).
+ */
+void R_VisCacheInvalidate (void)
+{
+    vis_key.valid = false;
+    num_vis_faces = 0;
+}
+
+/**
+ * \brief Build visibility key for this frame.
+ * \param[in] viewport Position of camera.
+ * \param[in] lvl Pointer to valid LevelData_t structure.
+ * \param[out] key Key to fill.
+ */
+static void R_VisBuildKey (placeonplane_t viewport, LevelData_t *lvl, r_viskey_t *key)
+{
+    memset (key, 0, sizeof (*key));
+
+    key->valid = true;
+    key->lvl = lvl;
+    key->origin[ 0 ] = viewport.origin[ 0 ];
+    key->origin[ 1 ] = viewport.origin[ 1 ];
+    key->angle = viewport.angle;
+    key->fov = g_fov;
+    key->door_epoch = lvl->Doors.epoch;
+    key->pw_active = PWall.active;
+
+    if (PWall.active) {
+        key->pw_x = PWall.x;
+        key->pw_y = PWall.y;
+        key->pw_moved = PWall.PWpointsmoved;
+    }
+}
+
+/**
+ * \brief Draw wall face and remember it for the next frame.
+ */
+static void R_VisWall (float x, float y, int type, int tex)
+{
+    R_Draw_Wall (x, y, LOWERZCOORD, UPPERZCOORD, type, tex);
+
+    if (num_vis_faces >= MAX_VIS_FACES) {
+        vis_key.valid = false; // too much to remember, trace again next frame
+        return;
+    }
+
+    vis_faces[ num_vis_faces ].x = x;
+    vis_faces[ num_vis_faces ].y = y;
+    vis_faces[ num_vis_faces ].type = type;
+    vis_faces[ num_vis_faces ].tex = tex;
+    num_vis_faces++;
+}
+
+/**
+ * \brief Draw door face and remember it for the next frame.
+ */
+static void R_VisDoor (int x, int y, bool vertical, bool backside, int tex, int amount)
+{
+    R_Draw_Door (x, y, LOWERZCOORD, UPPERZCOORD, vertical, backside, tex, amount);
+
+    if (num_vis_faces >= MAX_VIS_FACES) {
+        vis_key.valid = false;
+        return;
+    }
+
+    vis_faces[ num_vis_faces ].x = (float)x;
+    vis_faces[ num_vis_faces ].y = (float)y;
+    vis_faces[ num_vis_faces ].type = -1;
+    vis_faces[ num_vis_faces ].tex = tex;
+    vis_faces[ num_vis_faces ].vertical = vertical;
+    vis_faces[ num_vis_faces ].backside = backside;
+    vis_faces[ num_vis_faces ].amount = amount;
+    num_vis_faces++;
+}
+
 /**
  * \brief Ray cast viewport.
  * \param[in] viewport Position of camera.
  * \param[in] lvl Pointer to valid LevelData_t structure.
- * \return Marks all visible tiles in tile_visible[] array.
+ * \return true if last frame's visible set was reused, otherwise false.
+ * \note Marks all visible tiles in tile_visible[] array.
+ *       If neither the camera, a door nor the push-wall moved since the
+ *       last call, tile_visible[] is left as is and the remembered faces
+ *       are drawn again without tracing.
  */
-void R_RayCast (placeonplane_t viewport, LevelData_t *lvl)
+bool R_RayCast (placeonplane_t viewport, LevelData_t *lvl)
 {
     int n, x, y, vx, vy;
     float angle;
     r_trace_t trace;
+    r_viskey_t key;
 
 
 
-    float tanfov2 = (float)TanDgr (g_fov / 2.0) * (640.0f / 480.0f);
+    float tanfov2;
     float tanval;
 
+    R_VisBuildKey (viewport, lvl, &key);
+
+    if (vis_key.valid && ! memcmp (&key, &vis_key, sizeof (key))) {
+        r_viscache_stats.hits++;
+
+        for (n = 0 ; n < num_vis_faces ; ++n) {
+            if (vis_faces[ n ].type == -1) {
+                R_Draw_Door ((int)vis_faces[ n ].x, (int)vis_faces[ n ].y, LOWERZCOORD, UPPERZCOORD,
+                             vis_faces[ n ].vertical, vis_faces[ n ].backside,
+                             vis_faces[ n ].tex, vis_faces[ n ].amount);
+            } else {
+                R_Draw_Wall (vis_faces[ n ].x, vis_faces[ n ].y, LOWERZCOORD, UPPERZCOORD,
+                             vis_faces[ n ].type, vis_faces[ n ].tex);
+            }
+        }
+
+        return true;
+    }
+
+    r_viscache_stats.misses++;
+
+    memcpy (&vis_key, &key, sizeof (key));
+    num_vis_faces = 0;
+
+    tanfov2 = (float)TanDgr (g_fov / 2.0) * (640.0f / 480.0f);
+
     memset (tile_visible, 0, sizeof (tile_visible));   // clear tile visible flags
 
 // viewport tile coordinates
     x = viewport.origin[ 0 ];
     y = viewport.origin[ 1 ];
 
-    angle = viewport.angle;
+    angle = FINE2RAD (viewport.angle);
 
     vx = POS2TILE (viewport.origin[ 0 ]);
     vy = POS2TILE (viewport.origin[ 1 ]);
@@ -98,10 +241,10 @@ void R_RayCast (placeonplane_t viewport, LevelData_t *lvl)
                 // door
                 if (lvl->tilemap[ x ][ y ] & DOOR_TILE) {
 
-                    if (lvl->Doors.DoorMap[ x ][ y ].action != dr_open) {
+                    if (DOOR_AT (&lvl->Doors, x, y)->action != dr_open) {
                         bool backside = false;
 
-                        if (lvl->Doors.DoorMap[ x ][ y ].vertical) {
+                        if (DOOR_AT (&lvl->Doors, x, y)->vertical) {
                             if (x < vx)
                                 backside = true;
                         } else {
@@ -109,38 +252,38 @@ void R_RayCast (placeonplane_t viewport, LevelData_t *lvl)
                                 backside = true;
                         }
 
-                        R_Draw_Door (x, y, LOWERZCOORD, UPPERZCOORD,
-                                     lvl->Doors.DoorMap[ x ][ y ].vertical,
-                                     backside,
-                                     lvl->Doors.DoorMap[ x ][ y ].texture,
-                                     Door_Opened (&lvl->Doors, x, y));
+                        R_VisDoor (x, y,
+                                   DOOR_AT (&lvl->Doors, x, y)->vertical,
+                                   backside,
+                                   DOOR_AT (&lvl->Doors, x, y)->texture,
+                                   Door_Opened (&lvl->Doors, x, y));
                     }
 
                     /* door sides */
-                    if (lvl->Doors.DoorMap[ x ][ y ].vertical) {
+                    if (DOOR_AT (&lvl->Doors, x, y)->vertical) {
                         if (y <= vy)
-                            R_Draw_Wall ((float)x, (float) (y - 1), LOWERZCOORD, UPPERZCOORD, dir4_north, TEX_PLATE);
+                            R_VisWall ((float)x, (float) (y - 1), dir4_north, TEX_PLATE);
 
                         if (y >= vy)
-                            R_Draw_Wall ((float)x, (float) (y + 1), LOWERZCOORD, UPPERZCOORD, dir4_south, TEX_PLATE);
+                            R_VisWall ((float)x, (float) (y + 1), dir4_south, TEX_PLATE);
 
                         if (x <= vx && lvl->tilemap[ x - 1 ][ y ] & WALL_TILE)
-                            R_Draw_Wall ((float) (x - 1), (float)y, LOWERZCOORD, UPPERZCOORD, dir4_east, lvl->wall_tex_x[ x - 1 ][ y ]);
+                            R_VisWall ((float) (x - 1), (float)y, dir4_east, lvl->wall_tex_x[ x - 1 ][ y ]);
 
                         if (x >= vx && lvl->tilemap[ x + 1 ][ y ] & WALL_TILE)
-                            R_Draw_Wall ((float) (x + 1), (float)y, LOWERZCOORD, UPPERZCOORD, dir4_west, lvl->wall_tex_x[ x + 1 ][ y ]);
+                            R_VisWall ((float) (x + 1), (float)y, dir4_west, lvl->wall_tex_x[ x + 1 ][ y ]);
                     } else {
                         if (x <= vx)
-                            R_Draw_Wall ((float) (x - 1), (float)y, LOWERZCOORD, UPPERZCOORD, dir4_east, TEX_PLATE + 1);
+                            R_VisWall ((float) (x - 1), (float)y, dir4_east, TEX_PLATE + 1);
 
                         if (x >= vx)
-                            R_Draw_Wall ((float) (x + 1), (float)y, LOWERZCOORD, UPPERZCOORD, dir4_west, TEX_PLATE + 1);
+                            R_VisWall ((float) (x + 1), (float)y, dir4_west, TEX_PLATE + 1);
 
                         if (y <= vy && lvl->tilemap[ x ][ y - 1 ] & WALL_TILE)
-                            R_Draw_Wall ((float)x, (float) (y - 1), LOWERZCOORD, UPPERZCOORD, dir4_north, lvl->wall_tex_y[x][y - 1]);
+                            R_VisWall ((float)x, (float) (y - 1), dir4_north, lvl->wall_tex_y[x][y - 1]);
 
                         if (y >= vy && lvl->tilemap[ x ][ y + 1 ] & WALL_TILE)
-                            R_Draw_Wall ((float)x, (float) (y + 1), LOWERZCOORD, UPPERZCOORD, dir4_south, lvl->wall_tex_y[x][y + 1]);
+                            R_VisWall ((float)x, (float) (y + 1), dir4_south, lvl->wall_tex_y[x][y + 1]);
                     }
                 } else {
                     /* Push-Wall */
@@ -153,38 +296,40 @@ void R_RayCast (placeonplane_t viewport, LevelData_t *lvl)
 
 
                         if (PWall.x <= vx)
-                            R_Draw_Wall ((float)PWall.x + dx, (float)PWall.y + dy, LOWERZCOORD, UPPERZCOORD, dir4_east, PWall.tex_x);
+                            R_VisWall ((float)PWall.x + dx, (float)PWall.y + dy, dir4_east, PWall.tex_x);
 
                         if (PWall.x >= vx)
-                            R_Draw_Wall ((float)PWall.x + dx, (float)PWall.y + dy, LOWERZCOORD, UPPERZCOORD, dir4_west, PWall.tex_x);
+                            R_VisWall ((float)PWall.x + dx, (float)PWall.y + dy, dir4_west, PWall.tex_x);
 
                         if (PWall.y <= vy)
-                            R_Draw_Wall ((float)PWall.x + dx, (float)PWall.y + dy, LOWERZCOORD, UPPERZCOORD, dir4_north, PWall.tex_y);
+                            R_VisWall ((float)PWall.x + dx, (float)PWall.y + dy, dir4_north, PWall.tex_y);
 
                         if (PWall.y >= vy)
-                            R_Draw_Wall ((float)PWall.x + dx, (float)PWall.y + dy, LOWERZCOORD, UPPERZCOORD, dir4_south, PWall.tex_y);
+                            R_VisWall ((float)PWall.x + dx, (float)PWall.y + dy, dir4_south, PWall.tex_y);
 
                     }
 
                     /* x-wall */
                     if (x <= vx && r_world->tilemap[ x - 1 ][ y ] & WALL_TILE)
-                        R_Draw_Wall ((float) (x - 1), (float)y, LOWERZCOORD, UPPERZCOORD, dir4_east, r_world->wall_tex_x[x - 1][y]);
+                        R_VisWall ((float) (x - 1), (float)y, dir4_east, r_world->wall_tex_x[x - 1][y]);
 
                     if (x >= vx && r_world->tilemap[ x + 1 ][ y ] & WALL_TILE)
-                        R_Draw_Wall ((float) (x + 1), (float)y, LOWERZCOORD, UPPERZCOORD, dir4_west, r_world->wall_tex_x[x + 1][y]);
+                        R_VisWall ((float) (x + 1), (float)y, dir4_west, r_world->wall_tex_x[x + 1][y]);
 
                     /* y-wall */
                     if (y <= vy && r_world->tilemap[ x ][ y - 1 ] & WALL_TILE)
-                        R_Draw_Wall ((float)x, (float) (y - 1), LOWERZCOORD, UPPERZCOORD, dir4_north, r_world->wall_tex_y[x][y - 1]);
+                        R_VisWall ((float)x, (float) (y - 1), dir4_north, r_world->wall_tex_y[x][y - 1]);
 
                     if (y >= vy && r_world->tilemap[ x ][ y + 1 ] & WALL_TILE)
-                        R_Draw_Wall ((float)x, (float) (y + 1), LOWERZCOORD, UPPERZCOORD, dir4_south, r_world->wall_tex_y[x][y + 1]);
+                        R_VisWall ((float)x, (float) (y + 1), dir4_south, r_world->wall_tex_y[x][y + 1]);
 
                 }
 
             }
         }
     }
+
+    return false;
 }
 
 
@@ -226,7 +371,7 @@ static bool R_TraceCheck (LevelData_t *lvl, int x, int y, int frac, int dfrac, b
 
 
     if (lvl->tilemap[ x ][ y ] & DOOR_TILE &&
-            lvl->Doors.DoorMap[ x ][ y ].action != dr_open) {
+            DOOR_AT (&lvl->Doors, x, y)->action != dr_open) {
         frac += dfrac >> 1;
 
         if (POS2TILE (frac)) {
@@ -234,7 +379,7 @@ static bool R_TraceCheck (LevelData_t *lvl, int x, int y, int frac, int dfrac, b
         }
 
         if (vert) {
-            if (lvl->Doors.DoorMap[ x ][ y ].action != dr_closed &&
+            if (DOOR_AT (&lvl->Doors, x, y)->action != dr_closed &&
                     (frac >> 10) > DOOR_FULLOPEN - Door_Opened (&lvl->Doors, x, y)) {
                 return false; // opened enough
             }
@@ -243,7 +388,7 @@ static bool R_TraceCheck (LevelData_t *lvl, int x, int y, int frac, int dfrac, b
             trace->y = (y << TILE_SHIFT) + frac;
             trace->flags |= TRACE_HIT_VERT;
         } else {
-            if (lvl->Doors.DoorMap[ x ][ y ].action != dr_closed &&
+            if (DOOR_AT (&lvl->Doors, x, y)->action != dr_closed &&
                     (frac >> 10) < Door_Opened (&lvl->Doors, x, y)) {
                 return false; // opened enough
             }
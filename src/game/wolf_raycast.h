@@ -66,8 +66,16 @@ typedef struct r_trace_s {
 
 extern uint8_t tile_visible[ 64 ][ 64 ]; // can player see this tile?
 
+typedef struct {
+    uint32_t hits;      // frames that reused the previous visible set
+    uint32_t misses;    // frames that had to ray cast
+} r_viscache_stats_t;
 
-void R_RayCast (placeonplane_t viewport, LevelData_t *lvl);
+extern r_viscache_stats_t r_viscache_stats;
+
+
+void R_VisCacheInvalidate (void);
+bool R_RayCast (placeonplane_t viewport, LevelData_t *lvl);
 void R_Trace (r_trace_t *trace, LevelData_t *lvl);
 
 
@@ -0,0 +1,602 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file wolf_snapshot.c
+ * \brief Game state snapshots, quick save and rewind.
+ */
+
+/*!
+    \note
+
+    Snapshot layout: currentMap, LevelRatios, levelstate, PWall, Player,
+    areaconnect, NumGuards, ActorSlots, the entity_t and
+    entity_cold_t of every live actor, and last the level as runs of
+    { offset, length, bytes } that differ from the level as spawned, ended
+    by a run of length 0.
+
+    The rewind buffer is one block of memory used as a ring: snapshots are
+    put one after the other and the oldest are dropped to make room.
+
+*/
+
+#include <string.h>
+
+#include <zlib.h>
+
+#include "wolf_snapshot.h"
+#include "wolf_demo.h"
+#include "wolf_sprites.h"
+#include "wolf_raycast.h"
+#include "client.h"
+
+#include "../util/arena.h"
+#include "../util/timer.h"
+
+#define SNAP_RUN_GAP        8   // unchanged bytes that end a run of the level delta
+
+#define SNAP_RING_SIZE      (4 * 1024 * 1024)   // memory budget of the rewind buffer
+#define SNAP_RING_ENTRIES   512
+#define SNAP_REWIND_MSEC    500 // time between rewind snapshots
+
+extern uint8_t areaconnect[ NUMAREAS ][ NUMAREAS ];
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+
+} snapreader_t;
+
+typedef struct {
+    uint32_t offset;    // in snap_ring
+    uint32_t size;
+    float time;         // levelstate.time when taken
+    uint32_t msec;      // real time when taken
+
+} snapentry_t;
+
+// a snapshot read and checked, before any of it reaches the game
+typedef struct {
+    currentMap_t map;
+    LRstruct ratios;
+    level_locals_t levelstate;
+    Pwall_t pwall;
+    player_t player;
+    uint8_t areaconnect[ NUMAREAS ][ NUMAREAS ];
+    uint16_t numguards;
+    actorslots_t slots;
+    entity_t guards[ MAX_GUARDS + 1 ];
+    entity_cold_t cold[ MAX_GUARDS + 1 ];
+    snapreader_t level_delta;   // the runs, checked but not applied
+
+} snapdecoded_t;
+
+snap_stats_t snap_stats;
+
+// the level as Level_ScanInfoPlane left it, in level_arena
+static uint8_t *level_pristine;
+static uint32_t pristine_crc;
+static int pristine_episode, pristine_map, pristine_skill;
+
+static uint8_t snap_ring[ SNAP_RING_SIZE ];
+static snapentry_t snap_entries[ SNAP_RING_ENTRIES ];
+static int snap_first, snap_count;
+static uint32_t snap_last_msec;
+
+static snapdecoded_t snap_decoded;
+
+static uint8_t snap_quick[ SNAP_MAX_SIZE ];
+static size_t snap_quick_size;  // 0 if there is no quick save
+
+/**
+ * \brief Forget the rewind buffer and the quick save.
+ */
+static void Snap_Clear (void)
+{
+    snap_first = 0;
+    snap_count = 0;
+    snap_quick_size = 0;
+
+    memset (&snap_stats, 0, sizeof (snap_stats));
+}
+
+/**
+ * \brief Remember the level as spawned, snapshots only store what changed since.
+ * \param[in] lvl Level structure, right after Level_ScanInfoPlane.
+ */
+void Snap_KeepPristine (LevelData_t *lvl)
+{
+    Snap_Clear();
+
+    level_pristine = Arena_Alloc (&level_arena, SNAP_LEVEL_BYTES);
+
+    if (! level_pristine) {
+        return;
+    }
+
+    memcpy (level_pristine, lvl, SNAP_LEVEL_BYTES);
+    pristine_crc = crc32 (0, level_pristine, SNAP_LEVEL_BYTES);
+    pristine_episode = currentMap.episode;
+    pristine_map = currentMap.map;
+    pristine_skill = skill;
+}
+
+/**
+ * \brief Checksum of the level as spawned.
+ * \note Save games keep it, the level delta is only valid for this exact level.
+ */
+uint32_t Snap_LevelCrc (void)
+{
+    return pristine_crc;
+}
+
+/**
+ * \brief Which map is a snapshot of?
+ * \param[in] data Snapshot
+ * \param[in] size Snapshot size in bytes.
+ * \param[out] map Map, skill and completed maps of the snapshot.
+ * \return false if the snapshot is too short.
+ */
+bool Snap_PeekMap (const uint8_t *data, size_t size, currentMap_t *map)
+{
+    if (size < sizeof (*map)) {
+        return false;
+    }
+
+    memcpy (map, data, sizeof (*map));
+
+    return true;
+}
+
+/**
+ * \brief Can a snapshot of this map be restored without loading the map?
+ * \param[in] map Map from Snap_PeekMap.
+ */
+bool Snap_LevelReady (const currentMap_t *map)
+{
+    return r_world && level_pristine && pristine_episode == map->episode &&
+           pristine_map == map->map && pristine_skill == map->skill;
+}
+
+/**
+ * \brief Append bytes to a snapshot.
+ * \return Where the next bytes go.
+ */
+static uint8_t *Snap_Put (uint8_t *out, const void *data, size_t size)
+{
+    memcpy (out, data, size);
+
+    return out + size;
+}
+
+/**
+ * \brief Take bytes from a snapshot.
+ * \return false if the snapshot is too short.
+ */
+static bool Snap_Get (snapreader_t *in, void *data, size_t size)
+{
+    if (size > (size_t) (in->end - in->p)) {
+        return false;
+    }
+
+    memcpy (data, in->p, size);
+    in->p += size;
+
+    return true;
+}
+
+/**
+ * \brief Append the runs of level bytes that differ from the level as spawned.
+ * \param[in] out Where the runs go.
+ * \param[in] lvl Level structure
+ * \return Where the next bytes go.
+ * \note Runs closer than SNAP_RUN_GAP bytes are merged, a run header costs as much.
+ */
+static uint8_t *Snap_PutLevelDelta (uint8_t *out, const LevelData_t *lvl)
+{
+    const uint8_t *cur = (const uint8_t *) lvl;
+    uint32_t run[ 2 ];  // offset, length
+    size_t i = 0, gap;
+
+    while (i < SNAP_LEVEL_BYTES) {
+        if (cur[ i ] == level_pristine[ i ]) {
+            ++i;
+            continue;
+        }
+
+        run[ 0 ] = (uint32_t) i;
+
+        for (gap = 0 ; i < SNAP_LEVEL_BYTES && gap < SNAP_RUN_GAP ; ++i) {
+            gap = cur[ i ] == level_pristine[ i ] ? gap + 1 : 0;
+        }
+
+        run[ 1 ] = (uint32_t) (i - gap - run[ 0 ]);
+
+        out = Snap_Put (out, run, sizeof (run));
+        out = Snap_Put (out, cur + run[ 0 ], run[ 1 ]);
+    }
+
+    run[ 0 ] = run[ 1 ] = 0;
+
+    return Snap_Put (out, run, sizeof (run));
+}
+
+/**
+ * \brief Check the runs of level bytes without applying them.
+ * \param[in] in Snapshot, at the first run; left after the last one.
+ * \return false if the runs are damaged.
+ */
+static bool Snap_CheckLevelDelta (snapreader_t *in)
+{
+    uint32_t run[ 2 ];  // offset, length
+
+    for ( ; ; ) {
+        if (! Snap_Get (in, run, sizeof (run))) {
+            return false;
+        }
+
+        if (run[ 1 ] == 0) {
+            return true;
+        }
+
+        if (run[ 0 ] > SNAP_LEVEL_BYTES || run[ 1 ] > SNAP_LEVEL_BYTES - run[ 0 ] ||
+                run[ 1 ] > (size_t) (in->end - in->p)) {
+            return false;
+        }
+
+        in->p += run[ 1 ];
+    }
+}
+
+/**
+ * \brief Rebuild the level from the level as spawned and the runs.
+ * \param[in] in Runs checked by Snap_CheckLevelDelta.
+ * \param[in] lvl Level structure
+ */
+static void Snap_ApplyLevelDelta (snapreader_t in, LevelData_t *lvl)
+{
+    uint8_t *cur = (uint8_t *) lvl;
+    uint32_t run[ 2 ];  // offset, length
+
+    memcpy (cur, level_pristine, SNAP_LEVEL_BYTES);
+
+    while (Snap_Get (&in, run, sizeof (run)) && run[ 1 ]) {
+        Snap_Get (&in, cur + run[ 0 ], run[ 1 ]);
+    }
+}
+
+/**
+ * \brief Are the actor slots of a snapshot consistent?
+ * \param[in] snap Decoded snapshot
+ * \note Every slot must be either live, once, or free, once; live actors
+ *       must stand on the map and be in a known state.
+ */
+static bool Snap_CheckActors (const snapdecoded_t *snap)
+{
+    const actorslots_t *slots = &snap->slots;
+    const entity_t *ent;
+    bool used[ MAX_GUARDS + 1 ];
+    int n;
+
+    if (snap->numguards > MAX_GUARDS + 1 || slots->numfree != MAX_GUARDS + 1 - snap->numguards) {
+        return false;
+    }
+
+    memset (used, 0, sizeof (used));
+
+    for (n = 0 ; n < snap->numguards ; ++n) {
+        if (slots->live[ n ] > MAX_GUARDS || used[ slots->live[ n ] ] || slots->live_pos[ slots->live[ n ] ] != n) {
+            return false;
+        }
+
+        used[ slots->live[ n ] ] = true;
+        ent = &snap->guards[ slots->live[ n ] ];
+
+        if (ent->tilex < 0 || ent->tilex >= 64 || ent->tiley < 0 || ent->tiley >= 64 ||
+                (unsigned) ent->type >= NUMENEMIES || (unsigned) ent->state >= NUMSTATES) {
+            return false;
+        }
+    }
+
+    for (n = 0 ; n < slots->numfree ; ++n) {
+        if (slots->free[ n ] > MAX_GUARDS || used[ slots->free[ n ] ]) {
+            return false;
+        }
+
+        used[ slots->free[ n ] ] = true;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Read and check a whole snapshot.
+ * \param[in] data Snapshot
+ * \param[in] size Snapshot size in bytes.
+ * \param[out] snap Decoded snapshot.
+ * \return false if the snapshot is damaged or of another map, see Snap_LevelReady.
+ * \note Touches nothing of the game, so a bad snapshot leaves it as it was.
+ */
+static bool Snap_Decode (const uint8_t *data, size_t size, snapdecoded_t *snap)
+{
+    snapreader_t in;
+    int n;
+
+    in.p = data;
+    in.end = data + size;
+
+    if (! Snap_Get (&in, &snap->map, sizeof (snap->map)) || ! Snap_LevelReady (&snap->map) ||
+            ! Snap_Get (&in, &snap->ratios, sizeof (snap->ratios)) ||
+            ! Snap_Get (&in, &snap->levelstate, sizeof (snap->levelstate)) ||
+            ! Snap_Get (&in, &snap->pwall, sizeof (snap->pwall)) ||
+            ! Snap_Get (&in, &snap->player, sizeof (snap->player)) ||
+            ! Snap_Get (&in, snap->areaconnect, sizeof (snap->areaconnect)) ||
+            ! Snap_Get (&in, &snap->numguards, sizeof (snap->numguards)) ||
+            ! Snap_Get (&in, &snap->slots, sizeof (snap->slots)) ||
+            snap->numguards > MAX_GUARDS + 1) {
+        return false;
+    }
+
+    for (n = 0 ; n < snap->numguards ; ++n) {
+        if (snap->slots.live[ n ] > MAX_GUARDS ||
+                ! Snap_Get (&in, &snap->guards[ snap->slots.live[ n ] ], sizeof (entity_t)) ||
+                ! Snap_Get (&in, &snap->cold[ snap->slots.live[ n ] ], sizeof (entity_cold_t))) {
+            return false;
+        }
+    }
+
+    if (! Snap_CheckActors (snap) ||
+            snap->player.areanumber < 0 || snap->player.areanumber >= NUMAREAS) {
+        return false;
+    }
+
+    snap->level_delta = in;
+
+    return Snap_CheckLevelDelta (&in);
+}
+
+/**
+ * \brief Take a snapshot of the game.
+ * \param[in] out At least SNAP_MAX_SIZE bytes.
+ * \return Snapshot size in bytes, 0 if there is no level to take it of.
+ */
+size_t Snap_Capture (uint8_t *out)
+{
+    uint64_t start = Sys_Microseconds();
+    uint8_t *p = out;
+    int n;
+
+    if (! r_world || ! level_pristine) {
+        return 0;
+    }
+
+    p = Snap_Put (p, &currentMap, sizeof (currentMap));
+    p = Snap_Put (p, &LevelRatios, sizeof (LevelRatios));
+    p = Snap_Put (p, &levelstate, sizeof (levelstate));
+    p = Snap_Put (p, &PWall, sizeof (PWall));
+    p = Snap_Put (p, &Player, sizeof (Player));
+    p = Snap_Put (p, areaconnect, sizeof (areaconnect));
+
+    p = Snap_Put (p, &NumGuards, sizeof (NumGuards));
+    p = Snap_Put (p, &ActorSlots, sizeof (ActorSlots));
+
+    for (n = 0 ; n < NumGuards ; ++n) {
+        p = Snap_Put (p, &Guards[ ActorSlots.live[ n ] ], sizeof (entity_t));
+        p = Snap_Put (p, &GuardsCold[ ActorSlots.live[ n ] ], sizeof (entity_cold_t));
+    }
+
+    p = Snap_PutLevelDelta (p, r_world);
+
+    snap_stats.capture_usec = (uint32_t) (Sys_Microseconds() - start);
+
+    return (size_t) (p - out);
+}
+
+/**
+ * \brief Put the game back to a snapshot.
+ * \param[in] data Snapshot
+ * \param[in] size Snapshot size in bytes.
+ * \return false if the snapshot is damaged or of another map, see Snap_LevelReady.
+ * \note The whole snapshot is checked first, the game is only changed if it is good.
+ */
+bool Snap_Restore (const uint8_t *data, size_t size)
+{
+    uint64_t start = Sys_Microseconds();
+    snapdecoded_t *snap = &snap_decoded;
+    int n, slot;
+
+    if (! Snap_Decode (data, size, snap)) {
+        return false;
+    }
+
+    // everything below is replaced, only what caches it needs a reset
+    Sprite_Reset();
+    ResetGuards();
+
+    currentMap = snap->map;
+    LevelRatios = snap->ratios;
+    levelstate = snap->levelstate;
+    PWall = snap->pwall;
+    Player = snap->player;
+    memcpy (areaconnect, snap->areaconnect, sizeof (areaconnect));
+
+    NumGuards = snap->numguards;
+    ActorSlots = snap->slots;
+
+    for (n = 0 ; n < NumGuards ; ++n) {
+        slot = ActorSlots.live[ n ];
+        Guards[ slot ] = snap->guards[ slot ];
+        GuardsCold[ slot ] = snap->cold[ slot ];
+    }
+
+    Snap_ApplyLevelDelta (snap->level_delta, r_world);
+
+    ClientState.viewangles[ YAW ] = Player.position.angle;
+
+    Actor_RebuildTileIndex();
+    Areas_Rebuild (Player.areanumber);
+    Level_LOSReset (r_world);
+    Flow_Reset();
+    R_VisCacheInvalidate();
+
+    snap_stats.restore_usec = (uint32_t) (Sys_Microseconds() - start);
+
+    return true;
+}
+
+/**
+ * \brief Make room for one more snapshot in the rewind buffer.
+ * \return Where to take it, there are SNAP_MAX_SIZE bytes.
+ * \note Drops the oldest snapshots in the way.
+ */
+static uint32_t Snap_RingReserve (void)
+{
+    snapentry_t *first, *last;
+    uint32_t offset = 0;
+    uint32_t tail = SNAP_RING_SIZE;  // snapshots from here on are older than the ones at 0
+
+    if (snap_count) {
+        last = &snap_entries[ (snap_first + snap_count - 1) % SNAP_RING_ENTRIES ];
+        offset = last->offset + last->size;
+
+        if (offset + SNAP_MAX_SIZE > SNAP_RING_SIZE) {
+            tail = offset;
+            offset = 0;
+        }
+    }
+
+    while (snap_count) {
+        first = &snap_entries[ snap_first ];
+
+        if (snap_count < SNAP_RING_ENTRIES && first->offset < tail &&
+                (first->offset >= offset + SNAP_MAX_SIZE || first->offset + first->size <= offset)) {
+            break;
+        }
+
+        snap_first = (snap_first + 1) % SNAP_RING_ENTRIES;
+        snap_count--;
+    }
+
+    return offset;
+}
+
+/**
+ * \brief Update the rewind buffer figures for the statistics overlay.
+ */
+static void Snap_RingStats (void)
+{
+    int n;
+
+    snap_stats.count = snap_count;
+    snap_stats.bytes = 0;
+    snap_stats.span_msec = 0;
+
+    for (n = 0 ; n < snap_count ; ++n) {
+        snap_stats.bytes += snap_entries[ (snap_first + n) % SNAP_RING_ENTRIES ].size;
+    }
+
+    if (snap_count) {
+        snap_stats.span_msec = snap_entries[ (snap_first + snap_count - 1) % SNAP_RING_ENTRIES ].msec -
+                               snap_entries[ snap_first ].msec;
+    }
+}
+
+/**
+ * \brief Feed the rewind buffer.
+ * \note Call once per game frame, after the simulation ran.
+ */
+void Snap_Frame (void)
+{
+    uint32_t now = ClientStatic.realtime;
+    snapentry_t *entry;
+    uint32_t offset;
+
+    if (Player.playstate != ex_playing || ! level_pristine) {
+        return;
+    }
+
+    if (snap_count && now - snap_last_msec < SNAP_REWIND_MSEC) {
+        return;
+    }
+
+    offset = Snap_RingReserve();
+
+    entry = &snap_entries[ (snap_first + snap_count) % SNAP_RING_ENTRIES ];
+    entry->offset = offset;
+    entry->size = (uint32_t) Snap_Capture (snap_ring + offset);
+    entry->time = levelstate.time;
+    entry->msec = now;
+
+    if (entry->size) {
+        snap_count++;
+    }
+
+    snap_last_msec = now;
+    Snap_RingStats();
+}
+
+/**
+ * \brief Go back one step in the rewind buffer.
+ * \note Every call restores the newest snapshot older than the game, so
+ *       repeated calls keep going back.
+ */
+void Snap_Rewind (void)
+{
+    snapentry_t *last;
+
+    if (! level_pristine || Demo_Active()) {
+        return;
+    }
+
+    while (snap_count) {
+        last = &snap_entries[ (snap_first + snap_count - 1) % SNAP_RING_ENTRIES ];
+
+        if (last->time < levelstate.time) {
+            if (Snap_Restore (snap_ring + last->offset, last->size)) {
+                snap_last_msec = ClientStatic.realtime;
+                break;
+            }
+        }
+
+        snap_count--;
+    }
+
+    Snap_RingStats();
+}
+
+/**
+ * \brief Keep a snapshot until the next quick save or map.
+ */
+void Snap_QuickSave (void)
+{
+    if (Player.playstate != ex_playing) {
+        return;
+    }
+
+    snap_quick_size = Snap_Capture (snap_quick);
+}
+
+/**
+ * \brief Go back to the quick save.
+ */
+void Snap_QuickLoad (void)
+{
+    if (snap_quick_size && ! Demo_Active()) {
+        Snap_Restore (snap_quick, snap_quick_size);
+    }
+}
@@ -0,0 +1,79 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+ *  wolf_snapshot.h:   Game state snapshots, quick save and rewind.
+ *
+ */
+
+/*
+    Notes:
+    This module is implemented by wolf_snapshot.c
+
+    A snapshot is everything the simulation changes: the level as runs of
+    bytes that differ from the level as spawned, the live actors, areas,
+    push-wall, player, level state and the random number generator. Save
+    games are a compressed snapshot. Snapshots only restore onto the map
+    they were taken on; loading another map drops them.
+
+*/
+
+#ifndef __WOLF_SNAPSHOT_H__
+#define __WOLF_SNAPSHOT_H__
+
+#include <stddef.h>
+
+#include "wolf_local.h"
+#include "wolf_level.h"
+#include "wolf_actors.h"
+#include "wolf_player.h"
+
+#define SNAP_LEVEL_BYTES    offsetof (LevelData_t, fname)   // the rest is only needed while loading
+
+// worst case Snap_Capture: runs of one changed byte each, every actor slot in use
+#define SNAP_MAX_SIZE       (SNAP_LEVEL_BYTES * 2 + sizeof (Guards) + sizeof (GuardsCold) + \
+                             sizeof (actorslots_t) + sizeof (currentMap_t) + sizeof (LRstruct) + \
+                             sizeof (level_locals_t) + sizeof (Pwall_t) + sizeof (player_t) + \
+                             NUMAREAS * NUMAREAS + 64)
+
+typedef struct {
+    uint32_t count;         // snapshots in the rewind buffer
+    uint32_t bytes;         // used by them
+    uint32_t span_msec;     // time between the oldest and the newest
+    uint32_t capture_usec;  // last Snap_Capture
+    uint32_t restore_usec;  // last Snap_Restore
+
+} snap_stats_t;
+
+extern snap_stats_t snap_stats;
+
+void Snap_KeepPristine (LevelData_t *lvl);
+uint32_t Snap_LevelCrc (void);
+bool Snap_PeekMap (const uint8_t *data, size_t size, currentMap_t *map);
+bool Snap_LevelReady (const currentMap_t *map);
+
+size_t Snap_Capture (uint8_t *out);
+bool Snap_Restore (const uint8_t *data, size_t size);
+
+void Snap_Frame (void);
+void Snap_QuickSave (void);
+void Snap_QuickLoad (void);
+void Snap_Rewind (void);
+
+
+#endif /* __WOLF_SNAPSHOT_H__ */
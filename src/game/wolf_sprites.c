@@ -39,6 +39,10 @@
 #include "wolf_raycast.h"
 #include "wolf_player.h"
 
+static visobj_t static_vislist[ MAX_SPRITES ]; // visible sprites that did not move
+static int num_static_vis;
+static bool static_vis_dirty = true;
+
 
 /**
  * \brief Reset sprite status.
@@ -48,6 +52,8 @@ void Sprite_Reset (void)
 {
     levelData.numSprites = 0;
     memset (levelData.sprites, 0, sizeof (levelData.sprites));
+
+    static_vis_dirty = true;
 }
 
 /**
@@ -61,6 +67,10 @@ void Sprite_RemoveSprite (int sprite_id)
     }
 
     levelData.sprites[ sprite_id ].flags |= SPRT_REMOVE;
+
+    if (levelData.sprites[ sprite_id ].flags & SPRT_VIS_CACHED) {
+        static_vis_dirty = true;
+    }
 }
 
 /**
@@ -69,7 +79,7 @@ void Sprite_RemoveSprite (int sprite_id)
  */
 int Sprite_GetNewSprite (void)
 {
-    uint32_t n;
+    int n;
     sprite_t *sprt;
 
     for (n = 0, sprt = levelData.sprites ; n < levelData.numSprites ; ++n, ++sprt) {
@@ -99,6 +109,16 @@ void Sprite_SetPos (int sprite_id, int x, int y, int angle)
         return;
     }
 
+    // actors set this every tic; leave resting sprites eligible for the static vis cache
+    if (levelData.sprites[ sprite_id ].x == x && levelData.sprites[ sprite_id ].y == y &&
+            levelData.sprites[ sprite_id ].ang == angle) {
+        return;
+    }
+
+    if (levelData.sprites[ sprite_id ].flags & SPRT_VIS_CACHED) {
+        static_vis_dirty = true;
+    }
+
     levelData.sprites[ sprite_id ].x = x;
     levelData.sprites[ sprite_id ].y = y;
     levelData.sprites[ sprite_id ].ang = angle;
@@ -129,6 +149,18 @@ void Sprite_SetTex (int sprite_id, int index, int tex)
 
     //CacheTextures( tex, tex );
 
+    if (index == -1) {
+        if ((levelData.sprites[ sprite_id ].flags & SPRT_ONE_TEX) && levelData.sprites[ sprite_id ].tex[ 0 ] == tex) {
+            return;
+        }
+    } else if (! (levelData.sprites[ sprite_id ].flags & SPRT_ONE_TEX) && levelData.sprites[ sprite_id ].tex[ index ] == tex) {
+        return;
+    }
+
+    if (levelData.sprites[ sprite_id ].flags & SPRT_VIS_CACHED) {
+        static_vis_dirty = true;
+    }
+
     if (index == -1) {   // one texture for each phase
         levelData.sprites[ sprite_id ].tex[ 0 ] = tex;
         levelData.sprites[ sprite_id ].flags |= SPRT_ONE_TEX;
@@ -163,54 +195,113 @@ static int Sprite_cmpVis (const void *elem1, const void *elem2)
     }
 }
 
+/**
+ * \brief Check sprite against tile visibility array.
+ * \param[in] sprt Sprite to check.
+ * \param[out] visptr Filled in if sprite is visible.
+ * \return true if sprite is visible, otherwise false.
+ */
+static bool Sprite_CheckVis (sprite_t *sprt, visobj_t *visptr)
+{
+    uint32_t tx, ty;
+
+    tx = sprt->tilex;
+    ty = sprt->tiley;
+
+    if (tx > 63)
+        tx = 63;
+
+    if (ty > 63)
+        ty = 63;
+
+    // can be in any of 4 surrounding tiles; not 9 - see definition of tilex & tiley
+    if (! (tile_visible[ tx ][ ty ] || tile_visible[ tx + 1 ][ ty ] ||
+            tile_visible[ tx ][ ty + 1 ] || tile_visible[ tx + 1 ][ ty + 1 ])) {
+        return false;
+    }
+
+    // player spoted it
+    visptr->dist = LineLen2Point (sprt->x - Player.position.origin[ 0 ],
+                                  sprt->y - Player.position.origin[ 1 ],
+                                  Player.position.angle);  //FIXME viewport
+    visptr->x = sprt->x;
+    visptr->y = sprt->y;
+    //visptr->ang = sprt->ang;
+    visptr->tex = sprt->tex[ 0 ]; //FIXME!
+
+    return true;
+}
+
 /**
  * \brief Build and sort visibility list of sprites.
+ * \param[in] reuse_static true if tile_visible[] and the viewport are unchanged since last call.
  * \return Number of visible sprites.
  * \note
  *      List is sorted from far to near.
  *      List is based on tile visibility array, made by raycaster.
+ *      When reuse_static is set, sprites that have not moved since the last
+ *      full build are taken from the previous list and only the moving ones
+ *      are checked again.
  *      Called only by client.
  */
-int Sprite_CreateVisList (void)
+int Sprite_CreateVisList (bool reuse_static)
 {
-    uint32_t tx, ty, n, num_visible;
+    int n, num_visible;
     visobj_t *visptr;
     sprite_t *sprt;
 
     visptr = vislist;
     num_visible = 0;
 
-    for (n = 0, sprt = levelData.sprites; n < levelData.numSprites; ++n, ++sprt) {
-        if (sprt->flags & SPRT_REMOVE) {
-            continue;
-        }
+    if (reuse_static && ! static_vis_dirty) {
+        memcpy (vislist, static_vislist, num_static_vis * sizeof (visobj_t));
+        visptr += num_static_vis;
+        num_visible = num_static_vis;
+
+        for (n = 0, sprt = levelData.sprites; n < levelData.numSprites; ++n, ++sprt) {
+            if (sprt->flags & (SPRT_REMOVE | SPRT_VIS_CACHED) ||
+                    ! (sprt->flags & (SPRT_CHG_POS | SPRT_CHG_TEX | SPRT_VIS_DYNAMIC))) {
+                continue;
+            }
 
-        tx = sprt->tilex;
-        ty = sprt->tiley;
+            if (num_visible >= MAX_SPRITES) {
+                break; // vislist full
+            }
 
-        if (tx > 63)
-            tx = 63;
+            if (Sprite_CheckVis (sprt, visptr)) {
+                num_visible++;
+                visptr++;
+            }
+        }
+    } else {
+        num_static_vis = 0;
+        static_vis_dirty = false;
 
-        if (ty > 63)
-            ty = 63;
+        for (n = 0, sprt = levelData.sprites; n < levelData.numSprites; ++n, ++sprt) {
+            sprt->flags &= ~(SPRT_VIS_CACHED | SPRT_VIS_DYNAMIC);
 
-        // can be in any of 4 surrounding tiles; not 9 - see definition of tilex & tiley
-        if (tile_visible[ tx ][ ty ] || tile_visible[ tx + 1 ][ ty ] ||
-                tile_visible[ tx ][ ty + 1 ] || tile_visible[ tx + 1 ][ ty + 1 ]) {
-            // player spoted it
-            visptr->dist = LineLen2Point (sprt->x - Player.position.origin[ 0 ],
-                                          sprt->y - Player.position.origin[ 1 ],
-                                          Player.position.angle);  //FIXME viewport
-            visptr->x = sprt->x;
-            visptr->y = sprt->y;
-            //visptr->ang = sprt->ang;
-            visptr->tex = sprt->tex[ 0 ]; //FIXME!
+            if (sprt->flags & SPRT_REMOVE) {
+                continue;
+            }
 
-            if (++num_visible > MAX_SPRITES) {
+            if (num_visible >= MAX_SPRITES) {
                 break; // vislist full
             }
 
-            visptr++;
+            if (Sprite_CheckVis (sprt, visptr)) {
+                if (sprt->flags & (SPRT_CHG_POS | SPRT_CHG_TEX)) {
+                    sprt->flags |= SPRT_VIS_DYNAMIC;
+                } else {
+                    static_vislist[ num_static_vis++ ] = *visptr;
+                    sprt->flags |= SPRT_VIS_CACHED;
+                }
+
+                num_visible++;
+                visptr++;
+            }
+
+            // anything that changes before the next full build is dynamic
+            sprt->flags &= ~(SPRT_CHG_POS | SPRT_CHG_TEX);
         }
     }
 // sorting list
@@ -220,4 +311,3 @@ int Sprite_CreateVisList (void)
 
     return num_visible;
 }
-
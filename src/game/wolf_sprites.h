@@ -281,6 +281,8 @@ enum {
 #define SPRT_CHG_POS    BIT( 3 )
 #define SPRT_CHG_TEX    BIT( 4 )
 #define SPRT_REMOVE     BIT( 5 )
+#define SPRT_VIS_CACHED BIT( 6 )
+#define SPRT_VIS_DYNAMIC BIT( 7 )
 
 typedef struct sprite_s {
     vec3_t position;
@@ -295,6 +297,8 @@ typedef struct sprite_s {
 // SPRT_CHG_POS
 // SPRT_CHG_TEX
 // SPRT_REMOVE
+// SPRT_VIS_CACHED: sprite sits in the static part of the visibility list
+// SPRT_VIS_DYNAMIC: sprite was visible but moving at the last full visibility build
     int flags;
 // 8 textures: one for each rotation phase!
 // if SPRT_ONE_TEX flag use tex with index 0!
@@ -322,6 +326,6 @@ void Sprite_RemoveSprite (int sprite_id);
 int Sprite_GetNewSprite (void);
 void Sprite_SetPos (int sprite_id, int x, int y, int angle);
 void Sprite_SetTex (int sprite_id, int index, int tex);
-int Sprite_CreateVisList (void);
+int Sprite_CreateVisList (bool reuse_static);
 
 #endif /* __WOLF_SPRITES_H__ */
\ No newline at end of file
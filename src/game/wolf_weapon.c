@@ -24,6 +24,7 @@
 #include "wolf_local.h"
 #include "wolf_raycast.h"
 #include "wolf_actor_ai.h"
+#include "../sound/soundfx.h"
 
 
 /**
@@ -32,26 +33,26 @@
  */
 void weapon_attack (player_t *self)
 {
-    entity_t *closest;
+    entity_t *closest, *ent;
     int damage;
     int dx, dy, dist;
     int d1, shot_dist, n;
 
     switch (self->weapon) {
     case WEAPON_KNIFE:
-        //Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("lsfx/023.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("lsfx/023.wav"), 1, ATTN_NORM, 0);
         break;
 
     case WEAPON_PISTOL:
-        //Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("sfx/012.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("sfx/012.wav"), 1, ATTN_NORM, 0);
         break;
 
     case WEAPON_MACHINEGUN:
-        //Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("sfx/011.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("sfx/011.wav"), 1, ATTN_NORM, 0);
         break;
 
     case WEAPON_GATLINGGUN:
-        //Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("sfx/013.wav"), 1, ATTN_NORM, 0);
+        Sound_StartSound (NULL, 0, CHAN_WEAPON, Sound_RegisterSound ("sfx/013.wav"), 1, ATTN_NORM, 0);
         break;
     }
 
@@ -61,12 +62,14 @@ void weapon_attack (player_t *self)
     closest = NULL;
 
     for (n = 0 ; n < NumGuards; ++n) {
-        if (Guards[ n ].flags & FL_SHOOTABLE) { // && Guards[n].flags&FL_VISABLE
+        ent = LIVE_GUARD (n);
+
+        if (ent->flags & FL_SHOOTABLE) { // && ent->flags&FL_VISABLE
             int guardwidth;
 
             if (!g_autoaim) {
                 // Make thin enemies harder to hit
-                switch (Guards[ n ].type) {
+                switch (ent->type) {
                 case en_guard:
                 case en_officer:
                 case en_ss:
@@ -82,25 +85,25 @@ void weapon_attack (player_t *self)
                 guardwidth = (2 * TILE_GLOBAL / 3);
             }
 
-            shot_dist = Point2LineDist (Guards[ n ].x - self->position.origin[ 0 ], Guards[ n ].y - self->position.origin[ 1 ], self->position.angle);
+            shot_dist = Point2LineDist (ent->x - self->position.origin[ 0 ], ent->y - self->position.origin[ 1 ], self->position.angle);
 
             if (shot_dist > guardwidth) {
                 continue; // miss
             }
 
-            d1 = LineLen2Point (Guards[ n ].x - self->position.origin[ 0 ], Guards[ n ].y - self->position.origin[ 1 ], self->position.angle);
+            d1 = LineLen2Point (ent->x - self->position.origin[ 0 ], ent->y - self->position.origin[ 1 ], self->position.angle);
 
             if (d1 < 0 || d1 > dist) {
                 continue;
             }
 
-            if (! Level_CheckLine (Guards[ n ].x, Guards[ n ].y, Player.position.origin[0], Player.position.origin[1], r_world)) {
-                //if( ! CheckLine( &Guards[ n ] ) )
+            if (! Level_CheckLine (ent->x, ent->y, Player.position.origin[0], Player.position.origin[1], r_world)) {
+                //if( ! CheckLine( ent ) )
                 continue; // obscured
             }
 
             dist = d1;
-            closest = &Guards[ n ];
+            closest = ent;
         }
     }
 
@@ -111,7 +114,7 @@ void weapon_attack (player_t *self)
             return;
         }
 
-        trace.angle = angle_normalize (self->position.angle - DEG2RAD (2) + (DEG2RAD (rand() % 4)));
+        trace.angle = FINE2RAD (FineNormalize (self->position.angle - 2 * ANG_1 + (US_RndT() % 4) * ANG_1));
 
         trace.x = self->position.origin[ 0 ];
         trace.y = self->position.origin[ 1 ];
@@ -121,7 +124,7 @@ void weapon_attack (player_t *self)
         R_Trace (&trace, r_world);
 
         if (trace.flags & TRACE_HIT_DOOR) {
-            //Sound_StartSound (NULL, 0, CHAN_AUTO, Sound_RegisterSound ("lsfx/028.wav"), 1, ATTN_NORM, 0);
+            Sound_StartSound (NULL, 0, CHAN_AUTO, Sound_RegisterSound ("lsfx/028.wav"), 1, ATTN_NORM, 0);
         }
 
         return;
@@ -29,6 +29,9 @@
  * \date 1997-2001
  */
 
+#include <math.h>
+#include <string.h>
+
 #include "opengl_local.h"
 
 /**
@@ -92,6 +95,154 @@ void R_Draw_Character (int x, int y, int num, font_t *myfont)
 }
 */
 
+/*
+    2D quads are not drawn when asked for: they are added to one vertex
+    array that is drawn when the texture or blend mode changes, when the
+    array is full, and before anything else is drawn (R_SetGL3D and
+    R_EndFrame). A HUD or menu frame that keeps to a few pictures takes a
+    few draw calls.
+*/
+
+#define BATCH_QUADS     2048
+
+static batchvert_t batch_verts[ BATCH_QUADS * 4 ];
+static int batch_quads;
+static int batch_texnum;
+static batchmode_t batch_mode;
+
+static const GLubyte batch_white[ 4 ] = { 255, 255, 255, 255 };
+
+static uint32_t batch_frame_quads;
+static uint32_t batch_frame_draws;
+
+r_batch_stats_t r_batch_stats;
+
+/**
+ * \brief Draw the batched quads.
+ * \note Sets the state the quads need and leaves it behind; the state
+ *       tracker drops whatever the next batch does not change.
+ */
+void R_Draw_Flush (void)
+{
+    if (! batch_quads) {
+        return;
+    }
+
+    if (batch_texnum) {
+        GL_Enable (GL_TEXTURE_2D);
+        texture_use (batch_texnum);
+    } else {
+        GL_Disable (GL_TEXTURE_2D);
+    }
+
+    switch (batch_mode) {
+    case BATCH_SOLID:
+        GL_Disable (GL_BLEND);
+        GL_AlphaFunc (GL_GREATER, 0.666f);
+        break;
+
+    case BATCH_TRANSLUCENT:
+        GL_Enable (GL_BLEND);
+        GL_BlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GL_AlphaFunc (GL_GREATER, 0.3f);
+        break;
+
+    case BATCH_MODULATE:
+        GL_Enable (GL_BLEND);
+        GL_BlendFunc (GL_SRC_COLOR, GL_DST_COLOR);
+        break;
+    }
+
+    // the arrays always point at batch_verts, and immediate mode
+    // drawing ignores them, so they are set up once
+    if (! gl_state.batch_arrays) {
+        glEnableClientState (GL_VERTEX_ARRAY);
+        glEnableClientState (GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState (GL_COLOR_ARRAY);
+
+        glVertexPointer (2, GL_FLOAT, sizeof (batchvert_t), &batch_verts[ 0 ].x);
+        glTexCoordPointer (2, GL_FLOAT, sizeof (batchvert_t), &batch_verts[ 0 ].s);
+        glColorPointer (4, GL_UNSIGNED_BYTE, sizeof (batchvert_t), batch_verts[ 0 ].colour);
+
+        gl_state.batch_arrays = true;
+    }
+
+    GL_DrawArrays (GL_QUADS, 0, batch_quads * 4);
+
+    GL_ColourUnknown();   // the colour array leaves it undefined
+
+    batch_frame_quads += batch_quads;
+    batch_frame_draws++;
+    batch_quads = 0;
+}
+
+/**
+ * \brief Make room for quads in the batch.
+ * \param[in] texnum Texture of the quads, 0 for none.
+ * \param[in] mode How the quads blend.
+ * \param[in] quads Number of quads, at most BATCH_QUADS.
+ * \return Four vertices per quad to fill in, clockwise from the top left.
+ */
+batchvert_t *R_Batch_Alloc (int texnum, batchmode_t mode, int quads)
+{
+    batchvert_t *v;
+
+    if (texnum != batch_texnum || mode != batch_mode || batch_quads + quads > BATCH_QUADS) {
+        R_Draw_Flush();
+
+        batch_texnum = texnum;
+        batch_mode = mode;
+    }
+
+    v = &batch_verts[ batch_quads * 4 ];
+    batch_quads += quads;
+
+    return v;
+}
+
+/**
+ * \brief Batch an axis aligned rectangle.
+ * \param[in] texnum Texture, 0 for none.
+ * \param[in] mode How the rectangle blends.
+ * \param[in] x1 Left.
+ * \param[in] y1 Top.
+ * \param[in] x2 Right.
+ * \param[in] y2 Bottom.
+ * \param[in] s1 Left texture coordinate.
+ * \param[in] t1 Top texture coordinate.
+ * \param[in] s2 Right texture coordinate.
+ * \param[in] t2 Bottom texture coordinate.
+ * \param[in] colour RGBA the texture is multiplied by.
+ */
+void R_Batch_Rect (int texnum, batchmode_t mode, float x1, float y1, float x2, float y2,
+                   float s1, float t1, float s2, float t2, const GLubyte *colour)
+{
+    batchvert_t *v = R_Batch_Alloc (texnum, mode, 1);
+
+    v[ 0 ].x = x1;  v[ 0 ].y = y1;  v[ 0 ].s = s1;  v[ 0 ].t = t1;
+    v[ 1 ].x = x2;  v[ 1 ].y = y1;  v[ 1 ].s = s2;  v[ 1 ].t = t1;
+    v[ 2 ].x = x2;  v[ 2 ].y = y2;  v[ 2 ].s = s2;  v[ 2 ].t = t2;
+    v[ 3 ].x = x1;  v[ 3 ].y = y2;  v[ 3 ].s = s1;  v[ 3 ].t = t2;
+
+    memcpy (v[ 0 ].colour, colour, 4);
+    memcpy (v[ 1 ].colour, colour, 4);
+    memcpy (v[ 2 ].colour, colour, 4);
+    memcpy (v[ 3 ].colour, colour, 4);
+}
+
+/**
+ * \brief Latch and clear the batch statistics.
+ * \note Called once a frame, after the last flush.
+ */
+void R_Batch_EndFrame (void)
+{
+    r_batch_stats.quads = batch_frame_quads;
+    r_batch_stats.draws = batch_frame_draws;
+
+    batch_frame_quads = 0;
+    batch_frame_draws = 0;
+}
+
 /**
  * \brief Draw image to the screen.
  * \param[in] x x-coordinate.
@@ -108,18 +259,8 @@ void R_Draw_Pic (int x, int y, const char *pic)
         return;
     }
 
-    texture_use(tex->id);
-
-    glBegin (GL_QUADS);
-        glTexCoord2f (0.0, 0.0);
-        glVertex2i (x, y);
-        glTexCoord2f (1.0, 0.0);
-        glVertex2i (x + tex->width, y);
-        glTexCoord2f (1.0, 1.0);
-        glVertex2i (x + tex->width, y + tex->height);
-        glTexCoord2f (0.0, 1.0);
-        glVertex2i (x, y + tex->height);
-    glEnd();
+    R_Batch_Rect (tex->id, BATCH_SOLID, x, y, x + tex->width, y + tex->height,
+                  0, 0, 1, 1, batch_white);
 }
 
 /**
@@ -139,21 +280,9 @@ void R_Draw_Tile (int x, int y, int w, int h, const char *pic)
     if (!(tex = texture_get_picture(pic)))
         return;
 
-    texture_use(tex->id);
-
-    glBegin (GL_QUADS);
-        glTexCoord2i (x / tex->width, y / tex->height);
-        glVertex2i (x, y);
-
-        glTexCoord2i ((x + w) / tex->width, y / tex->height);
-        glVertex2i (x + w, y);
-
-        glTexCoord2i ((x + w) / tex->width, (y + h) / tex->height);
-        glVertex2i (x + w, y + h);
-
-        glTexCoord2i (x / tex->width, (y + h) / tex->height);
-        glVertex2i (x, y + h);
-    glEnd();
+    R_Batch_Rect (tex->id, BATCH_SOLID, x, y, x + w, y + h,
+                  x / tex->width, y / tex->height, (x + w) / tex->width, (y + h) / tex->height,
+                  batch_white);
 }
 
 /**
@@ -168,19 +297,9 @@ void R_Draw_Tile (int x, int y, int w, int h, const char *pic)
  */
 void R_Draw_Fill (int x, int y, int w, int h, colour3_t c)
 {
-    glDisable (GL_TEXTURE_2D);
-
-    glColor3ubv (c);
-
-    glBegin (GL_QUADS);
-        glVertex2i (x, y);
-        glVertex2i (x + w, y);
-        glVertex2i (x + w, y + h);
-        glVertex2i (x, y + h);
-    glEnd();
+    GLubyte colour[ 4 ] = { c[ 0 ], c[ 1 ], c[ 2 ], 255 };
 
-    glColor3f (1, 1, 1);
-    glEnable (GL_TEXTURE_2D);
+    R_Batch_Rect (0, BATCH_SOLID, x, y, x + w, y + h, 0, 0, 0, 0, colour);
 }
 
 /**
@@ -191,21 +310,52 @@ void R_Draw_Fill (int x, int y, int w, int h, colour3_t c)
  * \param[in] nYEnd y-coordinate of ending point.
  * \param[in] c Colour value.
  * \return
- * \note
+ * \note Drawn as a quad so it batches with the rest. Lines along an axis
+ *       cover the pixels right and below them, others are centred.
  */
 void R_Draw_Line (int nXStart, int nYStart, int nXEnd, int nYEnd, int width, colour3_t c)
 {
-    glDisable (GL_TEXTURE_2D);
+    GLubyte colour[ 4 ] = { c[ 0 ], c[ 1 ], c[ 2 ], 255 };
+    batchvert_t *v;
+    float dx, dy, len;
+    int i;
+
+    if (nYStart == nYEnd || nXStart == nXEnd) {
+        if (nXStart > nXEnd) {
+            i = nXStart; nXStart = nXEnd; nXEnd = i;
+        }
+
+        if (nYStart > nYEnd) {
+            i = nYStart; nYStart = nYEnd; nYEnd = i;
+        }
+
+        if (nYStart == nYEnd) {
+            nYEnd += width;
+        } else {
+            nXEnd += width;
+        }
+
+        R_Batch_Rect (0, BATCH_SOLID, nXStart, nYStart, nXEnd, nYEnd, 0, 0, 0, 0, colour);
+        return;
+    }
 
-    glColor3ubv (c);
-    glLineWidth ((float)width);
+    dx = (float) (nXEnd - nXStart);
+    dy = (float) (nYEnd - nYStart);
+    len = sqrtf (dx * dx + dy * dy);
 
-    glBegin (GL_LINES);
-        glVertex2i (nXStart, nYStart);
-        glVertex2i (nXEnd, nYEnd);
-    glEnd();
+    // half the width across the line
+    dx = dx / len * width * 0.5f;
+    dy = dy / len * width * 0.5f;
 
-    glColor3f (1, 1, 1);
+    v = R_Batch_Alloc (0, BATCH_SOLID, 1);
+
+    v[ 0 ].x = nXStart + dy;    v[ 0 ].y = nYStart - dx;
+    v[ 1 ].x = nXEnd + dy;      v[ 1 ].y = nYEnd - dx;
+    v[ 2 ].x = nXEnd - dy;      v[ 2 ].y = nYEnd + dx;
+    v[ 3 ].x = nXStart - dy;    v[ 3 ].y = nYStart + dx;
 
-    glEnable (GL_TEXTURE_2D);
-}
\ No newline at end of file
+    for (i = 0 ; i < 4 ; ++i) {
+        v[ i ].s = v[ i ].t = 0;
+        memcpy (v[ i ].colour, colour, 4);
+    }
+}
@@ -40,15 +40,79 @@ extern  int intensity;
 
 void texture_use(int texnum);
 
+// capabilities tracked by GL_Enable / GL_Disable
+#define GLS_TEXTURE_2D      1
+#define GLS_BLEND           2
+#define GLS_ALPHA_TEST      4
+#define GLS_DEPTH_TEST      8
+#define GLS_CULL_FACE       16
+
+// what the projection matrix holds
+typedef enum {
+    PROJ_NONE,
+    PROJ_2D,
+    PROJ_3D
+
+} projection_t;
+
 typedef struct {
     float inverse_intensity;
     bool  fullscreen;
     int   prev_mode;
     int   bound_texture_id;
+
+    // shadow of the GL state, set by GL_SetDefaultState
+    int      enables;           // GLS_* bits
+    GLenum   blend_src, blend_dst;
+    GLenum   alpha_func;
+    GLclampf alpha_ref;
+    GLenum   depth_func;
+    GLenum   cull_face;
+    GLenum   matrix_mode;
+    GLfloat  colour[ 4 ];       // colour[ 0 ] < 0 when unknown
+    projection_t projection;
+    unsigned proj_width, proj_height;  // viddef size the 2D projection was set for
+    bool     batch_arrays;      // client arrays point at the 2D batch
+
 } glstate_t;
 
 extern glstate_t   gl_state;
 
+// Every state change goes through these, which drop calls that would
+// not change anything and count the rest, see opengl_main.c
+void GL_Enable (GLenum cap);
+void GL_Disable (GLenum cap);
+void GL_BlendFunc (GLenum sfactor, GLenum dfactor);
+void GL_AlphaFunc (GLenum func, GLclampf ref);
+void GL_DepthFunc (GLenum func);
+void GL_CullFace (GLenum mode);
+void GL_MatrixMode (GLenum mode);
+void GL_Color4f (GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+void GL_ColourUnknown (void);
+void GL_Begin (GLenum mode);
+void GL_DrawArrays (GLenum mode, GLint first, GLsizei count);
+void GL_CountBind (bool elided);
+
+// 2D quads are batched, see opengl_draw.c
+typedef enum {
+    BATCH_SOLID,        // alpha tested, the 2D default
+    BATCH_TRANSLUCENT,  // alpha blended, alpha tested at 0.3
+    BATCH_MODULATE      // multiplies the frame by its colour
+
+} batchmode_t;
+
+typedef struct {
+    GLfloat x, y;
+    GLfloat s, t;
+    GLubyte colour[ 4 ];
+
+} batchvert_t;
+
+batchvert_t *R_Batch_Alloc (int texnum, batchmode_t mode, int quads);
+void R_Batch_Rect (int texnum, batchmode_t mode, float x1, float y1, float x2, float y2,
+                   float s1, float t1, float s2, float t2, const GLubyte *colour);
+void R_Batch_EndFrame (void);
+
 void MYgluPerspective (GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar);
 
 void window_buffer_swap(void);
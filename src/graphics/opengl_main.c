@@ -26,14 +26,223 @@
  */
 
 #include <math.h>
+#include <string.h>
 
 #include "opengl_local.h"
 #include "video.h"
+#include "../util/timer.h"
 
 float  gldepthmin, gldepthmax;
 
 glstate_t  gl_state;
 
+r_gl_stats_t r_gl_stats;
+
+static r_gl_stats_t gl_frame;   // counted so far this frame
+
+r_frame_stats_t r_frame_stats;
+uint32_t r_frame_finish;
+bool r_swap_wait;
+
+static uint64_t frame_start;    // 0 outside R_BeginFrame / R_EndFrame
+static uint32_t frame_untimed;  // frames ended since the last glFinish
+
+
+/**
+ * \brief Bit of a capability in the shadow state.
+ * \param[in] cap GL capability.
+ * \return GLS_* bit, 0 if the capability is not tracked.
+ */
+static int GL_StateBit (GLenum cap)
+{
+    switch (cap) {
+    case GL_TEXTURE_2D:
+        return GLS_TEXTURE_2D;
+    case GL_BLEND:
+        return GLS_BLEND;
+    case GL_ALPHA_TEST:
+        return GLS_ALPHA_TEST;
+    case GL_DEPTH_TEST:
+        return GLS_DEPTH_TEST;
+    case GL_CULL_FACE:
+        return GLS_CULL_FACE;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief glEnable, unless the capability is already on.
+ * \param[in] cap GL capability.
+ */
+void GL_Enable (GLenum cap)
+{
+    int bit = GL_StateBit (cap);
+
+    if (bit && (gl_state.enables & bit)) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.enables |= bit;
+    gl_frame.changes++;
+    glEnable (cap);
+}
+
+/**
+ * \brief glDisable, unless the capability is already off.
+ * \param[in] cap GL capability.
+ */
+void GL_Disable (GLenum cap)
+{
+    int bit = GL_StateBit (cap);
+
+    if (bit && ! (gl_state.enables & bit)) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.enables &= ~bit;
+    gl_frame.changes++;
+    glDisable (cap);
+}
+
+/**
+ * \brief glBlendFunc, unless the factors are already set.
+ */
+void GL_BlendFunc (GLenum sfactor, GLenum dfactor)
+{
+    if (gl_state.blend_src == sfactor && gl_state.blend_dst == dfactor) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.blend_src = sfactor;
+    gl_state.blend_dst = dfactor;
+    gl_frame.changes++;
+    glBlendFunc (sfactor, dfactor);
+}
+
+/**
+ * \brief glAlphaFunc, unless the test is already set.
+ */
+void GL_AlphaFunc (GLenum func, GLclampf ref)
+{
+    if (gl_state.alpha_func == func && gl_state.alpha_ref == ref) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.alpha_func = func;
+    gl_state.alpha_ref = ref;
+    gl_frame.changes++;
+    glAlphaFunc (func, ref);
+}
+
+/**
+ * \brief glDepthFunc, unless the test is already set.
+ */
+void GL_DepthFunc (GLenum func)
+{
+    if (gl_state.depth_func == func) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.depth_func = func;
+    gl_frame.changes++;
+    glDepthFunc (func);
+}
+
+/**
+ * \brief glCullFace, unless the face is already culled.
+ */
+void GL_CullFace (GLenum mode)
+{
+    if (gl_state.cull_face == mode) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.cull_face = mode;
+    gl_frame.changes++;
+    glCullFace (mode);
+}
+
+/**
+ * \brief glMatrixMode, unless the matrix is already current.
+ */
+void GL_MatrixMode (GLenum mode)
+{
+    if (gl_state.matrix_mode == mode) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.matrix_mode = mode;
+    gl_frame.changes++;
+    glMatrixMode (mode);
+}
+
+/**
+ * \brief glColor4f, unless the colour is already current.
+ */
+void GL_Color4f (GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    if (gl_state.colour[ 0 ] == r && gl_state.colour[ 1 ] == g &&
+            gl_state.colour[ 2 ] == b && gl_state.colour[ 3 ] == a) {
+        gl_frame.elided++;
+        return;
+    }
+
+    gl_state.colour[ 0 ] = r;
+    gl_state.colour[ 1 ] = g;
+    gl_state.colour[ 2 ] = b;
+    gl_state.colour[ 3 ] = a;
+    gl_frame.changes++;
+    glColor4f (r, g, b, a);
+}
+
+/**
+ * \brief Forget the current colour.
+ * \note Drawing with a colour array leaves it undefined.
+ */
+void GL_ColourUnknown (void)
+{
+    gl_state.colour[ 0 ] = -1;
+}
+
+/**
+ * \brief glBegin, counted as a draw call.
+ */
+void GL_Begin (GLenum mode)
+{
+    gl_frame.draws++;
+    glBegin (mode);
+}
+
+/**
+ * \brief glDrawArrays, counted as a draw call.
+ */
+void GL_DrawArrays (GLenum mode, GLint first, GLsizei count)
+{
+    gl_frame.draws++;
+    glDrawArrays (mode, first, count);
+}
+
+/**
+ * \brief Count a texture bind, see texture_use.
+ * \param[in] elided true if the texture was bound already.
+ */
+void GL_CountBind (bool elided)
+{
+    if (elided) {
+        gl_frame.elided++;
+    } else {
+        gl_frame.binds++;
+    }
+}
+
 
 /**
  * \brief Set up a perspective projection matrix
@@ -65,25 +274,36 @@ static void R_Clear (void)
     glClear (GL_DEPTH_BUFFER_BIT);
     gldepthmin = 0;
     gldepthmax = 1;
-    glDepthFunc (GL_LEQUAL);
+    GL_DepthFunc (GL_LEQUAL);
     glDepthRange (gldepthmin, gldepthmax);
 }
 
 
 void R_SetGL2D (void)
 {
-    // set 2D virtual screen size
-    glViewport (0, 0, viddef.width, viddef.height);
-    glMatrixMode (GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho (0, viddef.width, viddef.height, 0, -99999, 99999);
-    glMatrixMode (GL_MODELVIEW);
-    glLoadIdentity();
-    glDisable (GL_DEPTH_TEST);
-    glDisable (GL_CULL_FACE);
-    glDisable (GL_BLEND);
-    glEnable (GL_ALPHA_TEST);
-    glColor4f(1, 1, 1, 1);
+    R_Draw_Flush();
+
+    // set 2D virtual screen size, unless it is set already
+    if (gl_state.projection != PROJ_2D ||
+            gl_state.proj_width != viddef.width || gl_state.proj_height != viddef.height) {
+        glViewport (0, 0, viddef.width, viddef.height);
+        GL_MatrixMode (GL_PROJECTION);
+        glLoadIdentity();
+        glOrtho (0, viddef.width, viddef.height, 0, -99999, 99999);
+        GL_MatrixMode (GL_MODELVIEW);
+        glLoadIdentity();
+        gl_frame.changes += 4;  // the viewport and the matrices
+
+        gl_state.projection = PROJ_2D;
+        gl_state.proj_width = viddef.width;
+        gl_state.proj_height = viddef.height;
+    }
+
+    GL_Disable (GL_DEPTH_TEST);
+    GL_Disable (GL_CULL_FACE);
+    GL_Disable (GL_BLEND);
+    GL_Enable (GL_ALPHA_TEST);
+    GL_Color4f (1, 1, 1, 1);
 }
 
 int opengl_init()
@@ -102,6 +322,8 @@ int opengl_init()
 
 void R_BeginFrame (void)
 {
+    frame_start = Sys_Microseconds();
+
     R_SetGL2D();
     glDrawBuffer(GL_BACK);
     R_Clear();
@@ -109,5 +331,34 @@ void R_BeginFrame (void)
 
 void R_EndFrame (void)
 {
+    R_Draw_Flush();
+    R_Batch_EndFrame();
+
+    r_gl_stats = gl_frame;
+    memset (&gl_frame, 0, sizeof (gl_frame));
+
+    // loading screens end frames they never began, those are not timed
+    if (frame_start) {
+        uint64_t now = Sys_Microseconds();
+
+        r_frame_stats.cpu_usec = (uint32_t) (now - frame_start);
+        r_frame_stats.timed = false;
+
+        // glFinish stalls the pipeline, so only now and then
+        if (r_frame_finish && ++frame_untimed >= r_frame_finish) {
+            glFinish();
+            r_frame_stats.gpu_usec = (uint32_t) (Sys_Microseconds() - now);
+            r_frame_stats.timed = true;
+            frame_untimed = 0;
+        }
+
+        frame_start = 0;
+    }
+
     window_buffer_swap();
+
+    if (r_swap_wait) {
+        glFinish();
+        r_swap_wait = false;
+    }
 }
\ No newline at end of file
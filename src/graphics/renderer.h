@@ -64,6 +64,36 @@ void R_Draw_Pic (int x, int y, const char *name);
 void R_Draw_Tile (int x, int y, int w, int h, const char *name);
 void R_Draw_Fill (int x, int y, int w, int h, colour3_t c);
 void R_Draw_Line (int nXStart, int nYStart, int nXEnd, int nYEnd, int width, colour3_t c);
+void R_Draw_Flush (void);
+
+typedef struct {
+    uint32_t quads;     // 2D quads last frame
+    uint32_t draws;     // draw calls they took
+
+} r_batch_stats_t;
+
+extern r_batch_stats_t r_batch_stats;
+
+typedef struct {
+    uint32_t draws;     // draw calls last frame
+    uint32_t binds;     // texture binds
+    uint32_t changes;   // other state changes sent to GL
+    uint32_t elided;    // binds and changes dropped as redundant
+
+} r_gl_stats_t;
+
+extern r_gl_stats_t r_gl_stats;
+
+typedef struct {
+    uint32_t cpu_usec;  // R_BeginFrame to the last draw call
+    uint32_t gpu_usec;  // waiting for GL to finish them, as of the last timed frame
+    bool     timed;     // gpu_usec was measured this frame
+
+} r_frame_stats_t;
+
+extern r_frame_stats_t r_frame_stats;
+extern uint32_t r_frame_finish;    // wait for GL at the end of every this many frames to time them, 0 never
+extern bool r_swap_wait;        // wait for the next swap to finish, then clear
 
 
 #endif /* __RENDERER_H__ */
@@ -0,0 +1,229 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file stats_overlay.c
+ * \brief Engine statistics overlay.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stats_overlay.h"
+#include "renderer.h"
+#include "wolf_renderer.h"
+#include "video.h"
+#include "color.h"
+#include "../util/com_string.h"
+#include "../util/timer.h"
+#include "../util/jobs.h"
+#include "../util/arena.h"
+#include "../game/wolf_raycast.h"
+#include "../game/wolf_level.h"
+#include "../game/wolf_actors.h"
+#include "../game/wolf_snapshot.h"
+#include "../sound/soundfx.h"
+#include "../sound/music.h"
+#include "../input/input.h"
+
+#define STATS_GLYPH     12  // glyph height in pixels
+#define STATS_X         8
+#define STATS_Y         8
+
+uint32_t stats_think_usec;
+
+static bool stats_visible = false;
+
+static uint32_t last_time;
+static uint32_t frame_msec;
+
+// input-to-photon test, see stats_latency_press
+static uint64_t latency_press;      // when the key was polled, 0 for no test
+static bool latency_flashed;        // the frame being drawn has the flash
+static uint32_t latency_usec;
+static uint32_t latency_mean_usec;
+static uint32_t latency_tests;
+
+/**
+ * \brief Show or hide the statistics overlay.
+ */
+void stats_overlay_toggle (void)
+{
+    stats_visible = ! stats_visible;
+}
+
+/**
+ * \brief Is the statistics overlay shown?
+ */
+bool stats_overlay_visible (void)
+{
+    return stats_visible;
+}
+
+/**
+ * \brief Start an input-to-photon test: the next frame flashes white.
+ * \param[in] usec When the key that started it was polled.
+ */
+void stats_latency_press (uint64_t usec)
+{
+    if (! latency_press) {
+        latency_press = usec;
+    }
+}
+
+/**
+ * \brief Finish the test once the flash is on screen.
+ * \note Must be called after R_EndFrame. The time taken is from the key
+ *       press being polled to GL having swapped the flash in; the display
+ *       itself adds its scan out on top.
+ */
+void stats_latency_end (void)
+{
+    if (! latency_flashed) {
+        return;
+    }
+
+    latency_usec = (uint32_t) (Sys_Microseconds() - latency_press);
+    latency_tests++;
+    latency_mean_usec = (uint32_t) (((uint64_t)latency_mean_usec * (latency_tests - 1) + latency_usec) / latency_tests);
+
+    printf ("input latency %u usec, mean %u usec over %u tests\n", latency_usec, latency_mean_usec, latency_tests);
+
+    latency_press = 0;
+    latency_flashed = false;
+}
+
+/**
+ * \brief Percentage of hits.
+ * \return 0-100, 0 when nothing was counted yet.
+ */
+static uint32_t stats_percent (uint32_t hits, uint32_t misses)
+{
+    uint64_t total = (uint64_t)hits + misses;
+
+    if (! total) {
+        return 0;
+    }
+
+    return (uint32_t) ((uint64_t)hits * 100 / total);
+}
+
+/**
+ * \brief Draws the statistics overlay.
+ * \note Must be called in 2D mode, after everything else for the frame is drawn.
+ */
+void stats_overlay_draw (void)
+{
+    char line[ 80 ];
+    uint32_t now = Sys_Milliseconds();
+    int y = STATS_Y;
+
+    frame_msec = now - last_time;
+    last_time = now;
+
+    if (latency_press && ! latency_flashed) {
+        R_Draw_Fill (0, 0, viddef.width, viddef.height, colourWhite);
+        latency_flashed = true;
+        r_swap_wait = true;
+    }
+
+    if (! stats_visible) {
+        return;
+    }
+
+    com_snprintf (line, sizeof (line), "FRAME %u MS", frame_msec);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "THINK %u US", stats_think_usec);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "ACTORS %u RUN %u SKIPPED",
+                  actorlod_stats.thinks, actorlod_stats.skipped);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "VIS CACHE %u%% %u/%u",
+                  stats_percent (r_viscache_stats.hits, r_viscache_stats.misses),
+                  r_viscache_stats.hits,
+                  r_viscache_stats.hits + r_viscache_stats.misses);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "LOS %u CACHED %u STATIC %u",
+                  level_los_stats.calls, level_los_stats.hits, level_los_stats.static_hits);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "SENSED %u THREADS %d",
+                  level_los_stats.sensed, Jobs_NumThreads () + 1);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "ALLOCS FRAME %u %u KB HEAP %u",
+                  mem_stats.frame_allocs, mem_stats.frame_bytes / 1024, mem_stats.heap_allocs);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "LEVEL ARENA %u/%u KB HEAP TOTAL %u",
+                  (uint32_t) (level_arena.used / 1024), (uint32_t) (level_arena.size / 1024), mem_stats.heap_total);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "REWIND %u %u KB %u S SNAP %u US RESTORE %u US",
+                  snap_stats.count, snap_stats.bytes / 1024, snap_stats.span_msec / 1000,
+                  snap_stats.capture_usec, snap_stats.restore_usec);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "SFX %u KB %u VOICES %u STOLEN %u DROPPED %u CULLED %u US",
+                  soundfx_stats.pcm_bytes / 1024, soundfx_stats.voices, soundfx_stats.stolen,
+                  soundfx_stats.dropped, soundfx_stats.culled, soundfx_stats.mix_usec);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "MUSIC %u MS AHEAD DECODE %u US/S %u UNDERRUNS",
+                  music_stats.buffered_msec, music_stats.decode_usec, music_stats.underruns);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "2D %u QUADS %u DRAWS HUD %u REDRAWS",
+                  r_batch_stats.quads, r_batch_stats.draws, r_hud_redraws);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "GL %u DRAWS %u BINDS %u CHANGES %u ELIDED",
+                  r_gl_stats.draws, r_gl_stats.binds, r_gl_stats.changes, r_gl_stats.elided);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "VIEW %u PERCENT CPU %u US GPU %u US",
+                  r_scale_percent, r_frame_stats.cpu_usec, r_frame_stats.gpu_usec);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "INPUT %u EVENTS %u US QUEUED %u DROPPED",
+                  input_stats.events, input_stats.age_usec, input_stats.dropped);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+    y += STATS_GLYPH;
+
+    com_snprintf (line, sizeof (line), "LATENCY %u US MEAN %u US F4 TESTS",
+                  latency_usec, latency_mean_usec);
+    R_put_line_scaled (STATS_X, y, STATS_GLYPH, line);
+}
@@ -0,0 +1,45 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+    Notes:
+    This module is implemented by stats_overlay.c
+
+    Engine counters drawn on top of the frame. Toggled in game with F3.
+
+    F4 measures input latency: the frame after the key press is white,
+    and the time from polling the key to that frame being swapped in is
+    shown and printed.
+*/
+
+#ifndef __STATS_OVERLAY_H__
+#define __STATS_OVERLAY_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+extern uint32_t stats_think_usec;  // ProcessGuards + Door_Process, last tic
+
+void stats_overlay_toggle (void);
+bool stats_overlay_visible (void);
+void stats_overlay_draw (void);
+
+void stats_latency_press (uint64_t usec);
+void stats_latency_end (void);
+
+#endif /* __STATS_OVERLAY_H__ */
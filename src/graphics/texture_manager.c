@@ -29,6 +29,7 @@
 #include "../common.h"
 #include "texture_manager.h"
 #include "../util/com_string.h"
+#include "../util/arena.h"
 #include "opengl_local.h"
 
 
@@ -81,6 +82,7 @@ void texture_tm_init(void)
 static void texture_upload(Texture *tex, uint8_t *data) {
     glGenTextures(1, &tex->id);
     glBindTexture(GL_TEXTURE_2D, tex->id);
+    gl_state.bound_texture_id = tex->id;   // batched quads bind through texture_use
 
     glTexImage2D(GL_TEXTURE_2D, 0, tex->bytes_per_pixel, tex->width, tex->height, 0, tex->bytes_per_pixel == 4 ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE, data);
 
@@ -103,9 +105,12 @@ void texture_cache_advance_index()
  */
 void texture_use(int id)
 {
-    if (gl_state.bound_texture_id == id)
+    if (gl_state.bound_texture_id == id) {
+        GL_CountBind(true);
         return;
+    }
 
+    GL_CountBind(false);
     gl_state.bound_texture_id = id;
     glBindTexture(GL_TEXTURE_2D, id);
 }
@@ -175,13 +180,16 @@ static Texture *texture_new_missing(void)
 {
     uint32_t  color = 0xFD5F00FF;
     size_t    size  = (16 * 16);
-    uint32_t *data  = malloc(size * 4);
+    uint32_t *data  = Arena_Alloc(&frame_arena, size * 4);
+
+    if (!data)
+        return no_texture;
 
     int x;
     for (x = 0; x < size; x++)
         data[x] = color;
 
-    Texture *tex = calloc(1, sizeof(Texture));
+    Texture *tex = Mem_Alloc(sizeof(Texture));
 
     if (!tex)
         return no_texture;
@@ -195,7 +203,6 @@ static Texture *texture_new_missing(void)
     strncpy(tex->name, "missing", MAX_GAMEPATH);
     set_filters(TT_Pic, tex);
     texture_upload(tex, data);
-    free (data);
 
     return tex;
 }
@@ -206,15 +213,17 @@ static Texture *texture_new_missing(void)
  */
 static Texture *texture_new(const char *name, TextureType type, uint32_t cache_index)
 {
-    Texture *tex = calloc(1, sizeof(Texture));
+    SDL_Surface *img = load_from_disk(name);
 
-    if (!tex)
+    if (!img)
         return no_texture;
 
-    SDL_Surface *img = load_from_disk(name);
+    Texture *tex = Mem_Alloc(sizeof(Texture));
 
-    if (!img)
+    if (!tex) {
+        SDL_free(img);
         return no_texture;
+    }
 
     tex->cache_index = cache_index;
     tex->type        = type;
@@ -246,7 +255,7 @@ void texture_cache_remove_unused(void)
         if (t->cache_index != texture_cache_index) {
             hashtable_iter_remove(&iter);
             glDeleteTextures(1, t->id);
-            free(t);
+            Mem_Free(t);
         }
     }
     hashtable_iter_init(&iter, walls);
@@ -257,7 +266,7 @@ void texture_cache_remove_unused(void)
         if (t->cache_index < texture_cache_index) {
             hashtable_iter_remove(&iter);
             glDeleteTextures(1, t->id);
-            free(t);
+            Mem_Free(t);
         }
     }
 }
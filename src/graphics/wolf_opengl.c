@@ -54,6 +54,7 @@
 #include "../game/../game/wolf_player.h"
 #include "../game/wolf_local.h"
 #include "../game/wolf_raycast.h"
+#include "wolf_renderer.h"
 
 extern viddef_t viddef;
 
@@ -61,6 +62,8 @@ extern viddef_t viddef;
 float cur_y_fov; // x & y field of view (in degrees)
 float ratio; // viewport width/height
 
+static const GLubyte white[ 4 ] = { 255, 255, 255, 255 };
+
 
 /**
  * \brief Set openGL default state
@@ -84,6 +87,102 @@ void GL_SetDefaultState (void)
     glShadeModel(GL_FLAT);
 
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glMatrixMode(GL_MODELVIEW);
+    glDepthFunc(GL_LESS);
+
+    // the shadow state starts out matching what was set above
+    gl_state.enables = GLS_TEXTURE_2D | GLS_ALPHA_TEST;
+    gl_state.blend_src = GL_SRC_ALPHA;
+    gl_state.blend_dst = GL_ONE_MINUS_SRC_ALPHA;
+    gl_state.alpha_func = GL_GREATER;
+    gl_state.alpha_ref = 0.666f;
+    gl_state.depth_func = GL_LESS;
+    gl_state.cull_face = GL_FRONT;
+    gl_state.matrix_mode = GL_MODELVIEW;
+    gl_state.colour[ 0 ] = gl_state.colour[ 1 ] = 1;
+    gl_state.colour[ 2 ] = gl_state.colour[ 3 ] = 1;
+    gl_state.projection = PROJ_NONE;
+    gl_state.batch_arrays = false;
+}
+
+static unsigned world_width, world_height;  // the 3D view is drawn at this size
+static GLuint world_texture;
+static unsigned world_tex_width, world_tex_height;
+
+/**
+ * \brief Size of a texture that can hold a copy of the screen.
+ * \param[in] size Width or height of the copy.
+ * \return The next power of two, GL 1.x only takes those.
+ */
+static unsigned R_CopyTexSize (unsigned size)
+{
+    unsigned tex = 1;
+
+    while (tex < size) {
+        tex <<= 1;
+    }
+
+    return tex;
+}
+
+/**
+ * \brief Set the resolution the 3D view is drawn at.
+ * \param[in] percent Percentage of the window size, at most 100.
+ * \param[out] w Width the view will be drawn at.
+ * \param[out] h Height the view will be drawn at.
+ * \note A view smaller than the window is drawn in its bottom left corner
+ *       and stretched over the window by R_UpscaleWorld.
+ */
+void R_SetWorldScale (int percent, int *w, int *h)
+{
+    if (R_CopyTexSize (viddef.width) > (unsigned) glMaxTexSize || R_CopyTexSize (viddef.height) > (unsigned) glMaxTexSize) {
+        percent = 100;  // no texture to stretch from
+    }
+
+    world_width = viddef.width * percent / 100;
+    world_height = viddef.height * percent / 100;
+
+    *w = world_width;
+    *h = world_height;
+}
+
+/**
+ * \brief Stretch the 3D view over the window.
+ * \note Must be called in 2D mode, before anything is drawn over the view.
+ */
+void R_UpscaleWorld (void)
+{
+    if (world_width >= viddef.width && world_height >= viddef.height) {
+        return;
+    }
+
+    R_Draw_Flush();   // the copy is taken from the back buffer
+
+    if (! world_texture) {
+        glGenTextures (1, &world_texture);
+    }
+
+    texture_use (world_texture);
+
+    if (world_tex_width != R_CopyTexSize (viddef.width) || world_tex_height != R_CopyTexSize (viddef.height)) {
+        world_tex_width = R_CopyTexSize (viddef.width);
+        world_tex_height = R_CopyTexSize (viddef.height);
+
+        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGB, world_tex_width, world_tex_height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    glCopyTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, 0, 0, world_width, world_height);
+
+    // the copy is upside down
+    R_Batch_Rect (world_texture, BATCH_SOLID, 0, 0, viddef.width, viddef.height,
+                  0, (float) world_height / world_tex_height,
+                  (float) world_width / world_tex_width, 0, white);
 }
 
 /**
@@ -102,22 +201,38 @@ static void R_CheckFOV (void)
  */
 void R_SetGL3D (placeonplane_t viewport)
 {
+    R_Draw_Flush();   // the 2D drawn so far, the background
     R_CheckFOV();
 
-    glMatrixMode (GL_PROJECTION);
+    if (! world_width) {
+        world_width = viddef.width;
+        world_height = viddef.height;
+    }
+
+    glViewport (0, 0, world_width, world_height);
+
+    GL_MatrixMode (GL_PROJECTION);
     glLoadIdentity();
     MYgluPerspective (cur_y_fov - 2.0f, ratio, 0.2f, 64.0f);
-    glMatrixMode (GL_MODELVIEW);
+    GL_MatrixMode (GL_MODELVIEW);
     glLoadIdentity();
 
-    glRotatef ((GLfloat) (90 - RAD2DEG (viewport.angle)), 0, 1, 0);
+    glRotatef ((GLfloat) (90 - RAD2DEG (FINE2RAD (viewport.angle))), 0, 1, 0);
     glTranslatef (-viewport.origin[ 0 ] / FLOATTILE, 0, viewport.origin[ 1 ] / FLOATTILE);
 
-    glCullFace (GL_BACK);
+    gl_state.projection = PROJ_3D;
 
-    glEnable (GL_DEPTH_TEST);
-    glEnable (GL_CULL_FACE);
-    glEnable (GL_BLEND);
+    // the whole 3D state, whatever the 2D batch left behind
+    GL_CullFace (GL_BACK);
+
+    GL_Enable (GL_TEXTURE_2D);
+    GL_Enable (GL_DEPTH_TEST);
+    GL_Enable (GL_CULL_FACE);
+    GL_Enable (GL_BLEND);
+    GL_Enable (GL_ALPHA_TEST);
+    GL_AlphaFunc (GL_GREATER, 0.666f);
+    GL_BlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GL_Color4f (1, 1, 1, 1);
 }
 
 /**
@@ -130,24 +245,7 @@ void R_SetGL3D (placeonplane_t viewport)
  */
 void R_DrawBox (int x, int y, int w, int h, uint32_t color)
 {
-    glDisable (GL_TEXTURE_2D);
-
-    glEnable (GL_BLEND);
-    glBlendFunc (GL_SRC_COLOR, GL_DST_COLOR);
-
-    glColor4ubv ((GLubyte *) & color);
-
-    glBegin (GL_QUADS);
-        glVertex2i (x, y);
-        glVertex2i (x, y + h);
-        glVertex2i (x + w, y + h);
-        glVertex2i (x + w, y);
-    glEnd();
-
-    glColor3f (1, 1, 1);
-    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable (GL_BLEND);
-    glEnable (GL_TEXTURE_2D);
+    R_Batch_Rect (0, BATCH_MODULATE, x, y, x + w, y + h, 0, 0, 0, 0, (GLubyte *) & color);
 }
 
 /**
@@ -180,6 +278,12 @@ void LoadWallTexture (int wallPicNum , bool *pIsDark)
     twall = texture_get_wall(wallPicNum);
     texture_use(twall->id);
 
+    if (isDark) {
+        GL_Color4f (0.7f, 0.7f, 0.7f, 1);
+    } else {
+        GL_Color4f (1, 1, 1, 1);
+    }
+
     if (pIsDark)
         *pIsDark = isDark;
 }
@@ -203,7 +307,6 @@ void LoadWallTexture (int wallPicNum , bool *pIsDark)
 void R_Draw_Wall (float x, float y, float z1, float z2, int type, int tex)
 {
     float x1, x2, y1, y2;
-    bool isDark;
 
     switch (type) {
     // X wall
@@ -233,13 +336,9 @@ void R_Draw_Wall (float x, float y, float z1, float z2, int type, int tex)
         break;
     }
 
-    LoadWallTexture (tex, &isDark);
-
-    if (isDark) {
-        glColor3f (0.7f, 0.7f, 0.7f);
-    }
+    LoadWallTexture (tex, NULL);
 
-    glBegin (GL_QUADS);
+    GL_Begin (GL_QUADS);
         glTexCoord2f (1.0, 0.0);
         glVertex3f (x1, z2, y1);
         glTexCoord2f (0.0, 0.0);
@@ -249,11 +348,6 @@ void R_Draw_Wall (float x, float y, float z1, float z2, int type, int tex)
         glTexCoord2f (1.0, 1.0);
         glVertex3f (x1, z1, y1);
     glEnd();
-
-    if (isDark) {
-        glColor3f (1.0f, 1.0f, 1.0f);
-    }
-
 }
 
 /**
@@ -269,7 +363,6 @@ void R_Draw_Wall (float x, float y, float z1, float z2, int type, int tex)
 void R_Draw_Door (int x, int y, float z1, float z2, bool vertical, bool backside, int tex, int amount)
 {
     float x1, x2, y1, y2, amt;
-    bool isDark;
 
     if (amount == DOOR_FULLOPEN) {
         return;
@@ -298,13 +391,9 @@ void R_Draw_Door (int x, int y, float z1, float z2, bool vertical, bool backside
         }
     }
 
-    LoadWallTexture (tex, &isDark);
-
-    if (isDark) {
-        glColor3f (0.7f, 0.7f, 0.7f);
-    }
+    LoadWallTexture (tex, NULL);
 
-    glBegin (GL_QUADS);
+    GL_Begin (GL_QUADS);
         glTexCoord2f (backside ? 0.0f : 1.0f, 0.0);
         glVertex3f (x1, z2, y1);
         glTexCoord2f (backside ? 1.0f : 0.0f, 0.0);
@@ -314,16 +403,13 @@ void R_Draw_Door (int x, int y, float z1, float z2, bool vertical, bool backside
         glTexCoord2f (backside ? 0.0f : 1.0f, 1.0);
         glVertex3f (x1, z1, y1);
     glEnd();
-
-    if (isDark) {
-        glColor3f (1.0f, 1.0f, 1.0f);
-    }
 }
 
 /**
  * \brief Draws all visible sprites.
+ * \param[in] reuse_static true if the ray caster reused last frame's visible set.
  */
-void R_DrawSprites (void)
+void R_DrawSprites (bool reuse_static)
 {
     float sina, cosa;
     float Ex, Ey, Dx, Dy;
@@ -333,18 +419,20 @@ void R_DrawSprites (void)
 
 // build visible sprites list
 
-    n_sprt = Sprite_CreateVisList();
+    n_sprt = Sprite_CreateVisList (reuse_static);
 
     if (! n_sprt) {
         return; // nothing to draw
     }
 
     // prepare values for billboarding
-    ang = angle_normalize (Player.position.angle + M_PI / 2);   // FIXME: take viewport
+    ang = angle_normalize (FINE2RAD (Player.position.angle) + M_PI / 2);   // FIXME: take viewport
 
     sina = (float) (0.5 * sin (ang));
     cosa = (float) (0.5 * cos (ang));
 
+    GL_Color4f (1, 1, 1, 1);   // the last wall may have been dark
+
     for (n = 0; n < n_sprt; ++n) {
         if (vislist[ n ].dist < MINDIST / 2) {
             continue; // little hack to save speed & z-buffer
@@ -354,7 +442,7 @@ void R_DrawSprites (void)
 
         texture_use(twall->id);
 
-        glBegin (GL_QUADS);
+        GL_Begin (GL_QUADS);
             Ex = Dx = vislist[ n ].x / FLOATTILE;
             Ey = Dy = vislist[ n ].y / FLOATTILE;
             Ex += cosa;
@@ -399,26 +487,70 @@ void R_DrawWeapon (void)
         //tex = texture_get_sprite (Player.weapon * 5 + Player.weaponframe + SPR_KNIFEREADY);
         tex = texture_get_sprite(422); // get_texture
     }
-    texture_use(tex->id);
+    R_Batch_Rect (tex->id, BATCH_TRANSLUCENT, x, y, (int) (x + w * scale), (int) (y + h * scale),
+                  0, 0, 1, 1, white);
+}
+
+static GLuint hud_texture;
+static int hud_tex_width, hud_tex_height;
+
+/**
+ * \brief Copy the freshly drawn heads-up-display into its texture.
+ * \param[in] x Left.
+ * \param[in] y Top.
+ * \param[in] w Width.
+ * \param[in] h Height.
+ * \return true if the copy can be drawn instead from now on.
+ * \note The status bar is opaque, so the copy holds only what it drew.
+ *       The copy fills the bottom left of a power of two texture.
+ */
+bool R_HUDCache_Capture (int x, int y, int w, int h)
+{
+    int tex_w = (int) R_CopyTexSize (w);
+    int tex_h = (int) R_CopyTexSize (h);
+
+    if (tex_w > glMaxTexSize || tex_h > glMaxTexSize) {
+        return false;
+    }
 
-    glAlphaFunc (GL_GREATER, 0.3f);
+    R_Draw_Flush();   // the copy is taken from the back buffer
 
-    glEnable (GL_BLEND);
+    if (! hud_texture) {
+        glGenTextures (1, &hud_texture);
+    }
 
-    glBegin (GL_QUADS);
-        glTexCoord2f (0.0f, 0.0f);
-        glVertex2i (x, y);
-        glTexCoord2f (1.0f, 0.0f);
-        glVertex2i (x + w * scale, y);
-        glTexCoord2f (1.0f, 1.0f);
-        glVertex2i (x + w * scale, y + h * scale);
-        glTexCoord2f (0.0f, 1.0f);
-        glVertex2i (x, y + h * scale);
-    glEnd();
+    texture_use (hud_texture);
+
+    if (tex_w != hud_tex_width || tex_h != hud_tex_height) {
+        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGB, tex_w, tex_h, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        hud_tex_width = tex_w;
+        hud_tex_height = tex_h;
+    }
+
+    // GL counts rows from the bottom of the window
+    glCopyTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, x, viddef.height - y - h, w, h);
 
-    glDisable (GL_BLEND);
+    return true;
+}
 
-    glAlphaFunc (GL_GREATER, 0.666f);
+/**
+ * \brief Draw the heads-up-display from its texture.
+ * \param[in] x Left.
+ * \param[in] y Top.
+ * \param[in] w Width.
+ * \param[in] h Height.
+ */
+void R_HUDCache_Draw (int x, int y, int w, int h)
+{
+    // the copy is upside down
+    R_Batch_Rect (hud_texture, BATCH_SOLID, x, y, x + w, y + h,
+                  0, (float) h / hud_tex_height, (float) w / hud_tex_width, 0, white);
 }
 
 /**
@@ -442,28 +574,15 @@ void R_DrawNumber (int x, int y, int number)
 
     tex = texture_get_picture("pics/N_NUMPIC.tga");
 
-    glEnable (GL_TEXTURE_2D);
+    for (i = length - 1 ; i >= 0 ; --i) {
+        col = string[ i ] - 48;
 
-    texture_use(tex->id);
+        fcol = col * w;
 
-    glBegin (GL_QUADS);
-        for (i = length - 1 ; i >= 0 ; --i) {
-            col = string[ i ] - 48;
+        R_Batch_Rect (tex->id, BATCH_SOLID, x, y, x + 18, y + 32, fcol, 0, fcol + w, 1, white);
 
-            fcol = col * w;
-
-            glTexCoord2f (fcol,    0);
-            glVertex2i (x, y);
-            glTexCoord2f (fcol + w, 0);
-            glVertex2i (x + 18, y);
-            glTexCoord2f (fcol + w, 1);
-            glVertex2i (x + 18, y + 32);
-            glTexCoord2f (fcol,    1);
-            glVertex2i (x, y + 32);
-
-            x -= 18;
-        }
-    glEnd();
+        x -= 18;
+    }
 }
 
 uint8_t wfont[ ] = {
@@ -480,6 +599,18 @@ uint8_t wfont[ ] = {
  * \param[in] string Text
  */
 void R_put_line (int x, int y, const char *string)
+{
+    R_put_line_scaled (x, y, 32, string);
+}
+
+/**
+ * \brief Draws a line of text with glyphs of the given size
+ * \param[in] x X-Coordinent
+ * \param[in] y Y-Coordinent
+ * \param[in] size Glyph height in pixels (font is drawn for 32)
+ * \param[in] string Text
+ */
+void R_put_line_scaled (int x, int y, int size, const char *string)
 {
     Texture *tex;
     int mx = x;
@@ -490,39 +621,28 @@ void R_put_line (int x, int y, const char *string)
 
     tex = texture_get_picture("pics/L_FONTPIC.tga");
 
-    texture_use(tex->id);
-
-    glBegin (GL_QUADS);
-        while (*string) {
-            if (*string == '\n') {
-                mx = x;
-                y += 32;
-                ++string;
-                continue;
-            }
-            num = *string;
-            num &= 255;
-
-            if ((num & 127) == 32) {
-                mx += 32;
-                ++string;
-                continue;       // space
-            }
-
-            frow = ((num >> 4) - 2) * h;
-            fcol = (num & 15) * w;
-
-            glTexCoord2f (fcol, frow);
-            glVertex2i (mx, y);
-            glTexCoord2f (fcol + w, frow);
-            glVertex2i (mx + 32, y);
-            glTexCoord2f (fcol + w, frow + h);
-            glVertex2i (mx + 32, y + 32);
-            glTexCoord2f (fcol, frow + h);
-            glVertex2i (mx, y + 32);
-
-            mx += wfont[ (num & 127) - 32 ];
+    while (*string) {
+        if (*string == '\n') {
+            mx = x;
+            y += size;
             ++string;
+            continue;
         }
-    glEnd();
-}
\ No newline at end of file
+        num = *string;
+        num &= 255;
+
+        if ((num & 127) == 32) {
+            mx += size;
+            ++string;
+            continue;       // space
+        }
+
+        frow = ((num >> 4) - 2) * h;
+        fcol = (num & 15) * w;
+
+        R_Batch_Rect (tex->id, BATCH_SOLID, mx, y, mx + size, y + size, fcol, frow, fcol + w, frow + h, white);
+
+        mx += wfont[ (num & 127) - 32 ] * size / 32;
+        ++string;
+    }
+}
@@ -34,6 +34,7 @@
 #include "../graphics/video.h"
 #include "../game/client.h"
 #include "../util/com_string.h"
+#include "../util/arena.h"
 
 #include "../game/wolf_local.h"
 #include "../game/wolf_menu.h"
@@ -54,42 +55,6 @@ static const char weaponnames[ 4 ][ 32 ] = {
     "pics/GATLINGGUNPIC.tga"
 };
 
-static int32_t hud_x, hud_y;
-
-
-/**
- * \brief Draws the heads-up-display
- */
-void R_DrawHUD (void)
-{
-    uint32_t score = Player.score;
-
-    Texture *t = texture_get_picture("pics/STATUSBARPIC.tga");
-    hud_x = (viddef.width - t->width) >> 1;
-    hud_y = viddef.height - t->height;
-    R_Draw_Pic (hud_x, hud_y, "pics/STATUSBARPIC.tga");
-
-    if (Player.items & ITEM_KEY_GOLD) {
-        R_Draw_Pic (hud_x + 480, hud_y + 8, "pics/GOLDKEYPIC.tga");
-    }
-
-    if (Player.items & ITEM_KEY_SILVER) {
-        R_Draw_Pic (hud_x + 480, hud_y + 40, "pics/SILVERKEYPIC.tga");
-    }
-
-    R_Draw_Pic (hud_x + 512, hud_y + 15, weaponnames[ Player.weapon ]);
-
-    // Clamp score
-    if (score > 999999) {
-        score = 999999;
-    }
-
-    R_DrawNumber (hud_x + 48, hud_y + 32, levelstate.floornum + 1);
-    R_DrawNumber (hud_x + 180, hud_y + 32, score);
-    R_DrawNumber (hud_x + 224, hud_y + 32, Player.lives);
-    R_DrawNumber (hud_x + 368, hud_y + 32, Player.health);
-    R_DrawNumber (hud_x + 444, hud_y + 32, Player.ammo[AMMO_BULLETS]); // FIXME!
-}
 
 static const char mugshotnames[ 24 ][ 32 ] = {
     "pics/FACE1APIC.tga",
@@ -131,57 +96,134 @@ static const char godmugshotnames[][ 32 ] = {
 
 
 /**
- * \brief Draws BJ's face on the heads-up-display
+ * \brief Pick BJ's face for the heads-up-display
+ * \return Picture name.
  */
-void R_DrawFace (void)
+static const char *R_FacePic (void)
 {
-    Player.facecount += tics;
+    int health;
+
+    if (! Player.health) {
+        if (Player.LastAttacker != ACTOR_NOHANDLE && Player.LastAttackerType == en_needle) {
+            return "pics/MUTANTBJPIC.tga";
+        }
 
-    if ((Player.face_gotgun || Player.face_ouch) && Player.facecount > 0) {
-        // gotgun/ouch will set facecount to a negative number initially, go back
-        // to normal face with random look after expired.
-        Player.face_gotgun = false;
-        Player.face_ouch = false;
+        return "pics/FACE8APIC.tga";
     }
 
-    if (Player.facecount > US_RndT()) {
-        Player.face_gotgun = false;
-        Player.face_ouch = false;
-        Player.faceframe = US_RndT() >> 6;
+    if (Player.face_gotgun) {
+        return "pics/GOTGATLINGPIC.tga";
+    }
 
-        if (Player.faceframe == 3) {
-            Player.faceframe = 0;
-        }
+    health = Player.health;
+
+    if (health > 100) {
+        health = 100;
+    }
 
-        Player.facecount = 0;
+    if (health < 0) {
+        health = 0;
     }
 
+    return mugshotnames[ 3 * ((100 - health) / 16) + Player.faceframe ];
+}
 
-    if (Player.health) {
-        if (Player.face_gotgun) {
-            R_Draw_Pic (hud_x + 272, hud_y + 8, "pics/GOTGATLINGPIC.tga");
-        }  else {
-            int health = Player.health;
+// everything the status bar shows, it is drawn again when this changes
+typedef struct {
+    int32_t x, y, w, h;
+    uint32_t score;
+    int floornum;
+    int lives;
+    int health;
+    int ammo;
+    int keys;
+    int weapon;
+    const char *face;   // NULL when the face is not shown
 
-            if (health > 100) {
-                health = 100;
-            }
+} hudkey_t;
 
-            if (health < 0) {
-                health = 0;
-            }
+static hudkey_t hud_key;
+static bool hud_cached;
 
-            R_Draw_Pic (hud_x + 272, hud_y + 8, mugshotnames[ 3 * ((100 - health) / 16) + Player.faceframe ]);
-        }
-    } else {
-        if (Player.LastAttacker && Player.LastAttacker->type == en_needle) {
-            R_Draw_Pic (hud_x + 272, hud_y + 8, "pics/MUTANTBJPIC.tga");
-        } else {
-            R_Draw_Pic (hud_x + 272, hud_y + 8, "pics/FACE8APIC.tga");
-        }
+uint32_t r_hud_redraws;
+
+/**
+ * \brief Draws the status bar
+ * \param[in] key What to show.
+ */
+static void R_DrawStatusBar (const hudkey_t *key)
+{
+    R_Draw_Pic (key->x, key->y, "pics/STATUSBARPIC.tga");
+
+    if (key->keys & ITEM_KEY_GOLD) {
+        R_Draw_Pic (key->x + 480, key->y + 8, "pics/GOLDKEYPIC.tga");
+    }
+
+    if (key->keys & ITEM_KEY_SILVER) {
+        R_Draw_Pic (key->x + 480, key->y + 40, "pics/SILVERKEYPIC.tga");
+    }
+
+    R_Draw_Pic (key->x + 512, key->y + 15, weaponnames[ key->weapon ]);
+
+    R_DrawNumber (key->x + 48, key->y + 32, key->floornum);
+    R_DrawNumber (key->x + 180, key->y + 32, key->score);
+    R_DrawNumber (key->x + 224, key->y + 32, key->lives);
+    R_DrawNumber (key->x + 368, key->y + 32, key->health);
+    R_DrawNumber (key->x + 444, key->y + 32, key->ammo); // FIXME!
+
+    if (key->face) {
+        R_Draw_Pic (key->x + 272, key->y + 8, key->face);
     }
 }
 
+/**
+ * \brief Draws the heads-up-display
+ * \param[in] face true to show BJ's face.
+ * \note The status bar is kept in a texture and only drawn again when
+ *       something on it changes, otherwise it is one quad.
+ */
+static void R_DrawHUDFace (bool face)
+{
+    hudkey_t key;
+    Texture *t = texture_get_picture("pics/STATUSBARPIC.tga");
+
+    memset (&key, 0, sizeof (key));   // compared as bytes
+
+    key.w = t->width;
+    key.h = t->height;
+    key.x = (viddef.width - t->width) >> 1;
+    key.y = viddef.height - t->height;
+
+    // Clamp score
+    key.score = Player.score > 999999 ? 999999 : Player.score;
+    key.floornum = levelstate.floornum + 1;
+    key.lives = Player.lives;
+    key.health = Player.health;
+    key.ammo = Player.ammo[ AMMO_BULLETS ];
+    key.keys = Player.items & (ITEM_KEY_GOLD | ITEM_KEY_SILVER);
+    key.weapon = Player.weapon;
+    key.face = face ? R_FacePic() : NULL;
+
+    if (hud_cached && ! memcmp (&key, &hud_key, sizeof (key))) {
+        R_HUDCache_Draw (key.x, key.y, key.w, key.h);
+        return;
+    }
+
+    R_DrawStatusBar (&key);
+
+    hud_cached = R_HUDCache_Capture (key.x, key.y, key.w, key.h);
+    hud_key = key;
+    r_hud_redraws++;
+}
+
+/**
+ * \brief Draws the heads-up-display
+ */
+void R_DrawHUD (void)
+{
+    R_DrawHUDFace (false);
+}
+
 
 int32_t r_damageflash = 0;
 
@@ -213,15 +255,97 @@ static void R_DrawFlash (void)
 
 /**
  * \brief Renders the background floor / ceiling colours.
- * \param[in] pitch Viewing angle
  * \param[in] floor floor colour.
  * \param[in] ceiling ceiling colour.
+ * \param[in] w Width of the 3D view.
+ * \param[in] h Height of the 3D view, which sits at the bottom of the window.
  */
-static void R_DrawBackGnd (colour3_t floor, colour3_t ceiling)
+static void R_DrawBackGnd (colour3_t floor, colour3_t ceiling, int w, int h)
 {
-    int h = (viddef.height >> 1); // half of height
-    R_Draw_Fill (0, 0, viddef.width, h, ceiling);
-    R_Draw_Fill (0, h, viddef.width, viddef.height - h, floor);
+    int y = viddef.height - h;
+    int half = (h >> 1); // half of height
+    R_Draw_Fill (0, y, w, half, ceiling);
+    R_Draw_Fill (0, y + half, w, h - half, floor);
+}
+
+
+/*
+    The 3D view is drawn at a lower resolution when frames take longer
+    than r_scale_target_usec, and stretched over the window. The scale
+    goes down a step after frames have been over the target for a while,
+    and up a step only when the frame time that step would take, going by
+    its pixel count, stays well under the target for longer. The gap
+    between the two keeps the scale from flipping back and forth.
+
+    Only every SCALE_SAMPLE_FRAMES-th frame waits for GL to finish, so
+    only those frames tell what a frame costs and feed the average.
+*/
+
+#define SCALE_MIN           50      // percent of the window size
+#define SCALE_STEP          10
+#define SCALE_DROP_FRAMES   8       // frames over the target before a step down
+#define SCALE_RAISE_FRAMES  60      // frames under it before a step up
+#define SCALE_SAMPLE_FRAMES 4       // frames per timed frame
+
+uint32_t r_scale_target_usec;
+uint32_t r_scale_percent = 100;
+
+static uint32_t scale_avg_usec;
+static int scale_over, scale_under;    // timed frames in a row over or under the target
+
+/**
+ * \brief Set the frame time the 3D view resolution adapts to.
+ * \param[in] usec Frame time in microseconds, 0 for full resolution.
+ */
+void R_Scale_SetTarget (uint32_t usec)
+{
+    r_scale_target_usec = usec;
+    r_scale_percent = 100;
+    r_frame_finish = usec ? SCALE_SAMPLE_FRAMES : 0;   // time what GL does too
+
+    scale_avg_usec = 0;
+    scale_over = scale_under = 0;
+}
+
+/**
+ * \brief Pick the 3D view resolution from the last frame's time.
+ */
+static void R_Scale_Update (void)
+{
+    uint32_t cost = r_frame_stats.cpu_usec + r_frame_stats.gpu_usec;
+    uint32_t next = r_scale_percent + SCALE_STEP;
+    uint64_t predicted;
+
+    if (! r_scale_target_usec || ! r_frame_stats.timed) {
+        return;
+    }
+
+    scale_avg_usec = (scale_avg_usec * 7 + cost) / 8;
+
+    predicted = (uint64_t)scale_avg_usec * next * next / (r_scale_percent * r_scale_percent);
+
+    if (scale_avg_usec > r_scale_target_usec) {
+        scale_over++;
+        scale_under = 0;
+    } else if (predicted < (uint64_t)r_scale_target_usec * 9 / 10) {
+        scale_under++;
+        scale_over = 0;
+    } else {
+        scale_over = scale_under = 0;
+    }
+
+    if (scale_over * SCALE_SAMPLE_FRAMES >= SCALE_DROP_FRAMES && r_scale_percent > SCALE_MIN) {
+        next = r_scale_percent - SCALE_STEP;
+    } else if (scale_under * SCALE_SAMPLE_FRAMES >= SCALE_RAISE_FRAMES && r_scale_percent < 100) {
+        next = r_scale_percent + SCALE_STEP;
+    } else {
+        return;
+    }
+
+    // guess the new frame time, so the average does not lag a step behind
+    scale_avg_usec = (uint32_t) ((uint64_t)scale_avg_usec * next * next / (r_scale_percent * r_scale_percent));
+    r_scale_percent = next;
+    scale_over = scale_under = 0;
 }
 
 
@@ -234,18 +358,25 @@ uint32_t intensity = 0;
 void R_DrawWorld (void)
 {
     placeonplane_t viewport;
+    bool vis_reused;
+    int w, h;
 
 // initializing
     viewport = Player.position;
 
-    R_DrawBackGnd (r_world->floorColour, r_world->ceilingColour);
+    R_Scale_Update();
+    R_SetWorldScale (r_scale_percent, &w, &h);
 
+    R_DrawBackGnd (r_world->floorColour, r_world->ceilingColour, w, h);
+
+    viewport.angle = Client_LatchViewAngle();   // the newest mouse look
     R_SetGL3D (viewport);
 
-    R_RayCast (viewport, r_world);
-    R_DrawSprites();
+    vis_reused = R_RayCast (viewport, r_world);
+    R_DrawSprites (vis_reused);
 
     R_SetGL2D();    // restore 2D back
+    R_UpscaleWorld();
 
     if (Player.playstate == ex_dead) {
         R_DrawBox (0, 0, viddef.width, viddef.height, (0xFF << 24) | (uint8_t)intensity);
@@ -264,8 +395,7 @@ void R_DrawWorld (void)
         R_DrawWeapon();
         R_DrawFlash();
     }
-    R_DrawHUD();
-    R_DrawFace();
+    R_DrawHUDFace (true);
 }
 
 
@@ -323,6 +453,9 @@ void R_BeginRegistration (const char *map)
     memset (&levelstate, 0, sizeof (levelstate));   // Reset gamestate
     ResetGuards();
 
+    R_VisCacheInvalidate();
+
+    Arena_Reset (&level_arena);   // everything the last map allocated
     r_world = Level_LoadMap (fullname);
 
     if (r_world == NULL) {
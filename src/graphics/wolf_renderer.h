@@ -47,6 +47,13 @@
 
 void R_SetGL3D (placeonplane_t viewport);
 
+void R_SetWorldScale (int percent, int *w, int *h);
+void R_UpscaleWorld (void);
+
+void R_Scale_SetTarget (uint32_t usec);
+
+extern uint32_t r_scale_percent;
+
 
 void R_ResetFlash (void);
 void R_DamageFlash (int damage);
@@ -59,7 +66,7 @@ void R_Draw_Wall (float x, float y, float z1, float z2, int type, int tex);
 
 
 
-void R_DrawSprites (void);
+void R_DrawSprites (bool reuse_static);
 
 void R_DrawPsyched (uint32_t percent);
 
@@ -67,8 +74,14 @@ void R_DrawHUD (void);
 void R_DrawNumber (int x, int y, int number);
 void R_DrawWeapon (void);
 
+bool R_HUDCache_Capture (int x, int y, int w, int h);
+void R_HUDCache_Draw (int x, int y, int w, int h);
+
+extern uint32_t r_hud_redraws;
+
 
 void R_put_line (int x, int y, const char *string);
+void R_put_line_scaled (int x, int y, int size, const char *string);
 
 
 #endif /* __WOLF_RENDERER_H__ */
@@ -1,21 +1,52 @@
 
 #include <SDL2/SDL.h>
+#include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <collectc/hashtable.h>
 
 #include "input.h"
+#include "../util/timer.h"
+
+/*
+ * Events are not handled when SDL hands them over: they are queued with
+ * the time they were polled and dispatched at the start of the tic they
+ * belong to. Polling can then happen as late as possible, also while a
+ * frame is drawn, without input changing the game in the middle of a tic.
+ * Mouse motion is only ever summed, so it is kept out of the queue.
+ */
+
+#define INPUT_EVENTS 256 // must be a power of two
+
+typedef struct input_event_s {
+    uint64_t  usec;
+    SDL_Event event;
+} InputEvent;
 
 static void process_key_event(InputContext *context, SDL_Event *e);
 
 static HashTable    *contexts   = NULL;
 static InputContext *active_cnt = NULL;
 
+static InputEvent events[INPUT_EVENTS];
+static uint32_t   events_head; // next to dispatch
+static uint32_t   events_tail; // next to fill
+
+static uint64_t dispatch_usec; // time of the event being dispatched
+static int      mouse_dx;
+
+InputStats input_stats;
+
 bool input_init()
 {
     contexts = hashtable_new();
     if (contexts == NULL)
         return false;
+
+    // motion is reported relative, however far the mouse travels
+    if (SDL_SetRelativeMouseMode(SDL_TRUE) != 0)
+        printf("Relative mouse mode unavailable: %s\n", SDL_GetError());
+
     return true;
 }
 
@@ -31,27 +62,31 @@ void input_add_context(InputContext *c, char *name)
     hashtable_add(contexts, name, c);
 }
 
+/**
+ * Queue the events SDL has, with the time they were polled.
+ */
 void input_poll()
 {
     SDL_Event event;
+    uint64_t  now = Sys_Microseconds();
 
     while (SDL_PollEvent(&event)) {
         switch (event.type) {
-        case SDL_WINDOWEVENT:
-            break;
         case SDL_QUIT:
             SDL_Quit();
             exit(0);
-        case SDL_MOUSEBUTTONDOWN:
-        case SDL_MOUSEBUTTONUP:
-            break;
         case SDL_KEYDOWN:
         case SDL_KEYUP:
-            process_key_event(active_cnt, &event);
+            if (events_tail - events_head == INPUT_EVENTS) {
+                input_stats.dropped++;
+                break;
+            }
+            events[events_tail & (INPUT_EVENTS - 1)].usec  = now;
+            events[events_tail & (INPUT_EVENTS - 1)].event = event;
+            events_tail++;
             break;
         case SDL_MOUSEMOTION:
-            break;
-        case SDL_MOUSEWHEEL:
+            mouse_dx += event.motion.xrel;
             break;
         default:
             break;
@@ -59,6 +94,56 @@ void input_poll()
     }
 }
 
+/**
+ * Dispatch the queued events polled up to a time, oldest first.
+ *
+ * @param[in] until Time the tic started, later events wait for the next one.
+ */
+void input_dispatch(uint64_t until)
+{
+    InputEvent *e;
+
+    input_stats.events   = 0;
+    input_stats.age_usec = 0;
+
+    while (events_head != events_tail) {
+        e = &events[events_head & (INPUT_EVENTS - 1)];
+
+        if (e->usec > until)
+            break;
+
+        if (until - e->usec > input_stats.age_usec)
+            input_stats.age_usec = (uint32_t) (until - e->usec);
+
+        dispatch_usec = e->usec;
+        events_head++;
+        input_stats.events++;
+
+        process_key_event(active_cnt, &e->event);
+    }
+}
+
+/**
+ * @return Time the event being dispatched was polled, for the key callbacks.
+ */
+uint64_t input_event_usec()
+{
+    return dispatch_usec;
+}
+
+/**
+ * Take the mouse motion summed since the last call.
+ *
+ * @return Horizontal motion, in mouse counts.
+ */
+int input_mouse_take()
+{
+    int dx = mouse_dx;
+
+    mouse_dx = 0;
+    return dx;
+}
+
 static void process_key_event(InputContext *context, SDL_Event *event)
 {
     if (context == NULL)
@@ -77,8 +162,9 @@ static void process_key_event(InputContext *context, SDL_Event *event)
     if (!map)
         return;
 
-    if (event->key.state == SDL_RELEASED && map->on_key_up != NULL)
-        map->on_key_up();
-    else if (!repeat || (repeat && map->repeat))
+    if (event->key.state == SDL_RELEASED) {
+        if (map->on_key_up != NULL)
+            map->on_key_up();
+    } else if (!repeat || (repeat && map->repeat))
         map->on_key_down();
 }
\ No newline at end of file
@@ -31,10 +31,22 @@
 #define __INPUT_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "input_context.h"
 
-bool input_init();
-void input_poll();
+typedef struct input_stats_s {
+    uint32_t events;   // key events dispatched last tic
+    uint32_t age_usec; // longest any of them waited in the queue
+    uint32_t dropped;  // events lost to a full queue
+} InputStats;
+
+extern InputStats input_stats;
+
+bool     input_init();
+void     input_poll();
+void     input_dispatch(uint64_t until);
+uint64_t input_event_usec();
+int      input_mouse_take();
 
 void input_add_context(InputContext *context, char *name);
 void input_set_context(char *name);
@@ -5,7 +5,9 @@
 #include "input.h"
 #include "input_bindings.h"
 #include "../game/client.h"
+#include "../game/wolf_snapshot.h"
 #include "../game/menu/intro.h"
+#include "../graphics/stats_overlay.h"
 
 
 void move_fw() {
@@ -73,6 +75,26 @@ void attack_stop() {
     ClientStatic.player.is_attacking = false;
 }
 
+void toggle_stats() {
+    stats_overlay_toggle();
+}
+
+void latency_test() {
+    stats_latency_press(input_event_usec());
+}
+
+void quick_save() {
+    Snap_QuickSave();
+}
+
+void quick_load() {
+    Snap_QuickLoad();
+}
+
+void rewind_game() {
+    Snap_Rewind();
+}
+
 static ButtonMap *forward;
 static ButtonMap *backward;
 static ButtonMap *strafe_l;
@@ -84,6 +106,13 @@ static ButtonMap *turn_r;
 static ButtonMap *pl_use;
 static ButtonMap *pl_attack;
 
+static ButtonMap *stats;
+static ButtonMap *latency;
+
+static ButtonMap *quicksave;
+static ButtonMap *quickload;
+static ButtonMap *rewind_step;
+
 void input_bindings_init()
 {
     InputContext *game  = icontext_new(true);
@@ -96,6 +125,11 @@ void input_bindings_init()
     turn_r    = button_map_new(SDL_SCANCODE_RIGHT, false, turn_right, turn_right_stop);
     pl_use    = button_map_new(SDL_SCANCODE_SPACE, false, use, use_stop);
     pl_attack = button_map_new(SDL_SCANCODE_LCTRL, false, attack, attack_stop);
+    stats     = button_map_new(SDL_SCANCODE_F3, false, toggle_stats, NULL);
+    latency   = button_map_new(SDL_SCANCODE_F4, false, latency_test, NULL);
+    quicksave = button_map_new(SDL_SCANCODE_F5, false, quick_save, NULL);
+    quickload = button_map_new(SDL_SCANCODE_F9, false, quick_load, NULL);
+    rewind_step = button_map_new(SDL_SCANCODE_BACKSPACE, false, rewind_game, NULL);
 
     icontext_add_key_map(game, forward);
     icontext_add_key_map(game, backward);
@@ -105,6 +139,11 @@ void input_bindings_init()
     icontext_add_key_map(game, turn_r);
     icontext_add_key_map(game, pl_use);
     icontext_add_key_map(game, pl_attack);
+    icontext_add_key_map(game, stats);
+    icontext_add_key_map(game, latency);
+    icontext_add_key_map(game, quicksave);
+    icontext_add_key_map(game, quickload);
+    icontext_add_key_map(game, rewind_step);
 
     input_add_context(game, "game");
 
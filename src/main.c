@@ -1,9 +1,17 @@
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
 #include "game/wolf_local.h"
+#include "game/wolf_demo.h"
+#include "game/wolf_headless.h"
+#include "game/client.h"
 #include "util/timer.h"
+#include "util/jobs.h"
 
 #include "graphics/window.h"
+#include "graphics/wolf_renderer.h"
 #include "sound/sound.h"
-#include "sound/music.h"
 #include "input/input.h"
 #include "input/input_bindings.h"
 #include "game/menu/intro.h"
@@ -11,6 +19,99 @@
 extern void StartGame(int a, int b, int g_skill);
 extern int opengl_init();
 
+/*
+    -record name      play E1M1 and save the input to name.dem
+    -playdemo name    play name.dem back
+    -timedemo name    play name.dem back as fast as possible, report and quit
+
+    -headless tics    run the game logic only, a bot or a demo plays
+    -worlds n         with -headless, run n worlds in parallel
+    -warp e m         with -headless, the bot plays episode e map m
+    -skill s          with -headless, the bot plays at skill s
+*/
+
+/**
+ * Find a command line option.
+ * @return Index of the option if it is there with its values, otherwise 0.
+ */
+static int arg_find(int argc, char *argv[], const char *name, int values)
+{
+    int i;
+
+    for (i = 1; i < argc - values; i++) {
+        if (!strcmp(argv[i], name)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+static const char *demo_name(int argc, char *argv[])
+{
+    int i;
+
+    if ((i = arg_find(argc, argv, "-playdemo", 1)) || (i = arg_find(argc, argv, "-timedemo", 1))) {
+        return argv[i + 1];
+    }
+    return NULL;
+}
+
+static bool demo_start(int argc, char *argv[])
+{
+    int record = arg_find(argc, argv, "-record", 1);
+    const char *name = demo_name(argc, argv);
+
+    if (!record && !name) {
+        return false;
+    }
+
+    input_set_context("game");
+    ClientStatic.menuState = IPM_GAME;
+    Game_Init();
+
+    if (record) {
+        return Demo_Record(argv[record + 1], 0, 0, 1);
+    }
+
+    return Demo_Play(name, arg_find(argc, argv, "-timedemo", 1) != 0);
+}
+
+/**
+ * Set the frame time the 3D view resolution adapts to, -frametime 0 turns it off.
+ */
+static void frametime_init(int argc, char *argv[])
+{
+    int i = arg_find(argc, argv, "-frametime", 1);
+    int msec = 14;  // a little under the 60 Hz swap interval
+
+    if (i) {
+        msec = atoi(argv[i + 1]);
+    }
+
+    R_Scale_SetTarget(msec > 0 ? msec * 1000 : 0);
+}
+
+static int headless_run(int argc, char *argv[], int i)
+{
+    int tics = atoi(argv[i + 1]);
+    int worlds = 1, episode = 0, map = 0, skill = 1;
+
+    if ((i = arg_find(argc, argv, "-worlds", 1))) {
+        worlds = atoi(argv[i + 1]);
+    }
+
+    if ((i = arg_find(argc, argv, "-warp", 2))) {
+        episode = atoi(argv[i + 1]);
+        map = atoi(argv[i + 2]);
+    }
+
+    if ((i = arg_find(argc, argv, "-skill", 1))) {
+        skill = atoi(argv[i + 1]);
+    }
+
+    return Headless_Run(episode, map, skill, demo_name(argc, argv), tics, worlds);
+}
+
 void systems_init()
 {
     // TODO load configurations
@@ -41,12 +142,23 @@ void systems_init()
 
     input_bindings_init();
 
+    // the main thread works along, one worker per remaining core
+    printf("Initializing worker threads...\n");
+    Jobs_Init(SDL_GetCPUCount() - 1);
+
     Client_Init();
 }
 
 int main(int argc, char *argv[])
 {
+    int headless = arg_find(argc, argv, "-headless", 1);
+
+    if (headless) {
+        return headless_run(argc, argv, headless);
+    }
+
     systems_init();
+    frametime_init(argc, argv);
 
     int time_delta;
     int time_start;
@@ -54,17 +166,27 @@ int main(int argc, char *argv[])
 
     time_start = Sys_Milliseconds();
 
-    music_play("");
+    bool timedemo;
 
-    intro_init();
+    if (!demo_start(argc, argv)) {
+        intro_init();
+    }
+
+    timedemo = Demo_Timedemo();
 
     while (1) {
-        input_poll();
         // find time spent rendering last frame
         do {
             time_current = Sys_Milliseconds();
             time_delta = time_current - time_start;
-        } while (time_delta < 1);
+        } while (time_delta < 1 && !timedemo);
+
+        // poll after waiting, so the tic gets the newest input
+        input_poll();
+
+        if (timedemo && !Demo_Active()) {
+            break;
+        }
 
         frame_run(time_delta);
         time_start = time_current;
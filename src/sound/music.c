@@ -3,31 +3,534 @@
 //
 
 #include <stdbool.h>
-#include <SDL_mixer.h>
 #include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL_mixer.h>
+#include <vorbis/vorbisfile.h>
 
 #include "music.h"
+#include "../util/com_string.h"
+#include "../util/filesystem.h"
+#include "../util/timer.h"
+
+#define MUSIC_SLOTS         3       // playing, fading out and prefetched
+#define MUSIC_RING_FRAMES   65536   // decoded ahead per track, power of two
+#define MUSIC_CHUNK         4096    // bytes decoded at a time
+#define MUSIC_CHUNK_FRAMES  8192    // most frames a chunk converts to
+#define MUSIC_FADE_MSEC     1500
+#define MUSIC_WAKE_MSEC     20
+#define MUSIC_NAME          64
+#define MUSIC_GAIN_ONE      65536
+#define MUSIC_NULL_FREQ     22050
+
+typedef struct {
+    // decoder thread only
+    char name[ MUSIC_NAME ];
+    bool open;
+    OggVorbis_File vf;
+    SDL_AudioStream *cvt;   // to the device rate and channels
+
+    int16_t ring[ MUSIC_RING_FRAMES * 2 ];
+    SDL_atomic_t write;     // frames, written by the decoder thread only
+    SDL_atomic_t read;      // frames, written by the mixer only
+    SDL_atomic_t target;    // gain to fade to, written by the decoder thread only
+    SDL_atomic_t gain;      // 0 - MUSIC_GAIN_ONE, written by the mixer only
+} musicslot_t;
+
+music_stats_t music_stats;
+
+static musicslot_t music_slots[ MUSIC_SLOTS ];
+static int music_current = -1;  // decoder thread only
+static int music_next = -1;     // prefetched, decoder thread only
+
+// main thread -> decoder thread, the lock is never held around file access
+static SDL_mutex *music_lock;
+static struct {
+    char play[ MUSIC_NAME ];
+    char prefetch[ MUSIC_NAME ];
+    bool stop;
+} music_request;
+
+static SDL_sem *music_wake;
+static SDL_Thread *music_thread;
+static SDL_atomic_t music_quit;
+
+static int music_freq = MUSIC_NULL_FREQ;
+static int music_channels = 2;
+static int music_fade_step;
+static bool music_hooked;
+
+/**
+ * \brief Is a slot neither heard nor about to be?
+ */
+static bool slot_silent(musicslot_t *slot)
+{
+    return ! SDL_AtomicGet(&slot->target) && ! SDL_AtomicGet(&slot->gain);
+}
+
+static int slot_find(const char *name)
+{
+    int i;
+
+    for (i = 0; i < MUSIC_SLOTS; ++i) {
+        if (music_slots[ i ].open && ! strcmp(music_slots[ i ].name, name)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void slot_close(musicslot_t *slot)
+{
+    if (slot->open) {
+        ov_clear(&slot->vf);
+        SDL_FreeAudioStream(slot->cvt);
+        slot->open = false;
+        slot->name[ 0 ] = '\0';
+    }
+}
+
+/**
+ * \brief A slot that can take a new track.
+ * \return -1 if all are in use, try again once a fade is over.
+ */
+static int slot_free(void)
+{
+    int i, found = -1;
+
+    for (i = 0; i < MUSIC_SLOTS; ++i) {
+        if (i == music_current || i == music_next || ! slot_silent(&music_slots[ i ])) {
+            continue;
+        }
+
+        if (! music_slots[ i ].open) {
+            return i;
+        }
+
+        found = i;
+    }
+
+    return found;
+}
+
+/**
+ * \brief Open a track in a silent slot.
+ * \return false if the file can't be read.
+ */
+static bool slot_open(musicslot_t *slot, const char *name)
+{
+    char path[ MAX_OSPATH ];
+    vorbis_info *info;
+
+    slot_close(slot);
+
+    com_snprintf(path, sizeof(path), "%s/%s", get_resource_base_path(), name);
+
+    if (ov_fopen(path, &slot->vf) != 0) {
+        printf("Unable to load %s!\n", path);
+        return false;
+    }
+
+    info = ov_info(&slot->vf, -1);
+    slot->cvt = SDL_NewAudioStream(AUDIO_S16SYS, info->channels, info->rate,
+                                   AUDIO_S16SYS, music_channels, music_freq);
+
+    if (! slot->cvt) {
+        printf("Unable to convert %s: %s\n", name, SDL_GetError());
+        ov_clear(&slot->vf);
+        return false;
+    }
+
+    // nobody reads a silent slot
+    SDL_AtomicSet(&slot->read, 0);
+    SDL_AtomicSet(&slot->write, 0);
+
+    com_snprintf(slot->name, sizeof(slot->name), "%s", name);
+    slot->open = true;
+
+    return true;
+}
+
+/**
+ * \brief Decode until the ring is full, looping at the end of the track.
+ * \return Microseconds spent.
+ */
+static uint32_t slot_fill(musicslot_t *slot)
+{
+    static char chunk[ MUSIC_CHUNK ];
+    static int16_t frames[ MUSIC_CHUNK_FRAMES * 2 ];
+    uint64_t start = Sys_Microseconds();
+    int frame_bytes = music_channels * (int) sizeof(int16_t);
+    uint32_t write = SDL_AtomicGet(&slot->write);
+    uint32_t space, pos, first;
+    int bitstream, got, n, rewinds = 0;
+    long len;
+
+    for ( ; ; ) {
+        space = MUSIC_RING_FRAMES - (write - (uint32_t) SDL_AtomicGet(&slot->read));
+
+        if (space < MUSIC_CHUNK_FRAMES) {
+            break;
+        }
+
+        got = SDL_AudioStreamGet(slot->cvt, frames, sizeof(frames)) / frame_bytes;
+
+        if (got <= 0) {
+            len = ov_read(&slot->vf, chunk, sizeof(chunk), SDL_BYTEORDER == SDL_BIG_ENDIAN, 2, 1, &bitstream);
+
+            if (len == 0) {
+                // loop, but not forever on a track without samples
+                if (++rewinds > 1 || ov_pcm_seek(&slot->vf, 0) != 0) {
+                    break;
+                }
+            } else if (len > 0) {
+                rewinds = 0;
+                SDL_AudioStreamPut(slot->cvt, chunk, (int) len);
+            } else {
+                break;  // damaged data, try again on the next wake
+            }
+
+            continue;
+        }
+
+        pos = write & (MUSIC_RING_FRAMES - 1);
+        first = MUSIC_RING_FRAMES - pos;
+        n = got < (int) first ? got : (int) first;
+
+        memcpy(slot->ring + pos * music_channels, frames, n * frame_bytes);
+        memcpy(slot->ring, frames + n * music_channels, (got - n) * frame_bytes);
+
+        write += got;
+        SDL_AtomicSet(&slot->write, write);   // full barrier, samples land before the count
+    }
+
+    return (uint32_t) (Sys_Microseconds() - start);
+}
+
+/**
+ * \brief Open, decode and close tracks as asked by the main thread.
+ */
+static int music_decoder(void *unused)
+{
+    char play[ MUSIC_NAME ] = "";
+    char prefetch[ MUSIC_NAME ] = "";
+    bool stop = false;
+    uint32_t window = Sys_Milliseconds();
+    uint32_t decode_usec = 0;
+    musicslot_t *slot;
+    int i, s;
+
+    (void) unused;
+
+    while (! SDL_AtomicGet(&music_quit)) {
+        SDL_SemWaitTimeout(music_wake, MUSIC_WAKE_MSEC);
+
+        SDL_LockMutex(music_lock);
+
+        if (music_request.stop) {
+            stop = true;
+            play[ 0 ] = '\0';
+        }
+
+        if (music_request.play[ 0 ]) {
+            com_snprintf(play, sizeof(play), "%s", music_request.play);
+            stop = false;
+        }
+
+        if (music_request.prefetch[ 0 ]) {
+            com_snprintf(prefetch, sizeof(prefetch), "%s", music_request.prefetch);
+        }
+
+        memset(&music_request, 0, sizeof(music_request));
+
+        SDL_UnlockMutex(music_lock);
+
+        if (stop) {
+            if (music_current >= 0) {
+                SDL_AtomicSet(&music_slots[ music_current ].target, 0);
+                music_current = -1;
+            }
+
+            stop = false;
+        }
+
+        // switch tracks, a slot still fading out comes back in
+        if (play[ 0 ]) {
+            s = slot_find(play);
 
-Mix_Music *music = NULL;
+            if (s < 0 && (s = slot_free()) >= 0) {
+                if (slot_open(&music_slots[ s ], play)) {
+                    decode_usec += slot_fill(&music_slots[ s ]);
+                } else {
+                    play[ 0 ] = '\0';
+                    s = -1;
+                }
+            }
 
-bool music_play(char *name)
+            if (s >= 0) {
+                if (music_current >= 0 && music_current != s) {
+                    SDL_AtomicSet(&music_slots[ music_current ].target, 0);
+                }
+
+                SDL_AtomicSet(&music_slots[ s ].target, MUSIC_GAIN_ONE);
+                music_current = s;
+
+                if (music_next == s) {
+                    music_next = -1;
+                }
+
+                play[ 0 ] = '\0';
+            }
+        }
+
+        if (prefetch[ 0 ]) {
+            s = slot_find(prefetch);
+
+            if (s < 0) {
+                music_next = -1;
+
+                if ((s = slot_free()) >= 0 && slot_open(&music_slots[ s ], prefetch)) {
+                    decode_usec += slot_fill(&music_slots[ s ]);
+                    music_next = s;
+                }
+
+                // no free slot yet: keep asking
+                if (s >= 0) {
+                    prefetch[ 0 ] = '\0';
+                }
+            } else {
+                if (s != music_current) {
+                    music_next = s;
+                }
+
+                prefetch[ 0 ] = '\0';
+            }
+        }
+
+        for (i = 0; i < MUSIC_SLOTS; ++i) {
+            slot = &music_slots[ i ];
+
+            if (! slot->open) {
+                continue;
+            }
+
+            if (i != music_current && i != music_next && slot_silent(slot)) {
+                slot_close(slot);
+            } else {
+                decode_usec += slot_fill(slot);
+            }
+        }
+
+        if (music_current >= 0) {
+            slot = &music_slots[ music_current ];
+            music_stats.buffered_msec = (uint32_t) (SDL_AtomicGet(&slot->write) - SDL_AtomicGet(&slot->read)) *
+                                        1000u / music_freq;
+        } else {
+            music_stats.buffered_msec = 0;
+        }
+
+        if (Sys_Milliseconds() - window >= 1000) {
+            music_stats.decode_usec = decode_usec;
+            decode_usec = 0;
+            window = Sys_Milliseconds();
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Add the audible tracks to a stream.
+ * \param[in,out] stream Signed 16 bit samples at the device rate and channel count.
+ * \param[in] frames Frames in stream.
+ * \note Called by the audio device. Never waits for the decoder thread.
+ */
+void music_mix(int16_t *stream, int frames)
+{
+    musicslot_t *slot;
+    const int16_t *src;
+    int16_t *dst;
+    uint32_t read;
+    int i, c, s, n, v, gain, target;
+
+    for (s = 0; s < MUSIC_SLOTS; ++s) {
+        slot = &music_slots[ s ];
+        gain = SDL_AtomicGet(&slot->gain);
+        target = SDL_AtomicGet(&slot->target);
+
+        if (! gain && ! target) {
+            continue;
+        }
+
+        read = SDL_AtomicGet(&slot->read);
+        n = (int) ((uint32_t) SDL_AtomicGet(&slot->write) - read);
+
+        if (n < frames) {
+            music_stats.underruns++;
+        } else {
+            n = frames;
+        }
+
+        dst = stream;
+
+        for (i = 0; i < n; ++i, ++read) {
+            if (gain < target) {
+                gain = gain + music_fade_step < target ? gain + music_fade_step : target;
+            } else if (gain > target) {
+                gain = gain - music_fade_step > target ? gain - music_fade_step : target;
+            }
+
+            src = slot->ring + (read & (MUSIC_RING_FRAMES - 1)) * music_channels;
+
+            for (c = 0; c < music_channels; ++c) {
+                v = *dst + ((src[ c ] * gain) >> 16);
+                *dst++ = v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t) v;
+            }
+        }
+
+        SDL_AtomicSet(&slot->read, read);
+        SDL_AtomicSet(&slot->gain, gain);
+    }
+}
+
+static void music_hook(void *udata, Uint8 *stream, int len)
+{
+    (void) udata;
+
+    music_mix((int16_t *) stream, len / (music_channels * (int) sizeof(int16_t)));
+}
+
+/**
+ * \brief Start the decoder thread.
+ * \param[in] null_device true if there is no audio device, otherwise SDL_mixer must be open.
+ * \return false on error, music stays off.
+ */
+bool music_init(bool null_device)
+{
+    Uint16 format;
+
+    if (! null_device) {
+        if (! Mix_QuerySpec(&music_freq, &format, &music_channels) ||
+                format != AUDIO_S16SYS || music_channels < 1 || music_channels > 2) {
+            printf("Unsupported audio format, music is off\n");
+            return false;
+        }
+    }
+
+    music_fade_step = MUSIC_GAIN_ONE / (music_freq * MUSIC_FADE_MSEC / 1000);
+
+    if (music_fade_step < 1) {
+        music_fade_step = 1;
+    }
+
+    music_lock = SDL_CreateMutex();
+    music_wake = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&music_quit, 0);
+    music_thread = SDL_CreateThread(music_decoder, "music", NULL);
+
+    if (! music_thread) {
+        printf("Unable to start the music thread: %s\n", SDL_GetError());
+        return false;
+    }
+
+    if (! null_device) {
+        Mix_HookMusic(music_hook, NULL);
+        music_hooked = true;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Stop the decoder thread and close every track.
+ */
+void music_shutdown(void)
 {
-    char *res = "./base/music/HITLWLTZ.ogg";
+    int i;
+
+    if (! music_thread) {
+        return;
+    }
 
-    //Load the music
-    music = Mix_LoadMUS(res);
+    // returns once the hook is no longer running
+    if (music_hooked) {
+        Mix_HookMusic(NULL, NULL);
+        music_hooked = false;
+    }
+
+    SDL_AtomicSet(&music_quit, 1);
+    SDL_SemPost(music_wake);
+    SDL_WaitThread(music_thread, NULL);
+    music_thread = NULL;
+
+    for (i = 0; i < MUSIC_SLOTS; ++i) {
+        slot_close(&music_slots[ i ]);
+        SDL_AtomicSet(&music_slots[ i ].target, 0);
+        SDL_AtomicSet(&music_slots[ i ].gain, 0);
+    }
 
-    //If there was a problem loading the music
-    if(music == NULL) {
-        printf("Unable to load %s!\n", res);
+    music_current = music_next = -1;
+
+    SDL_DestroySemaphore(music_wake);
+    SDL_DestroyMutex(music_lock);
+}
+
+/**
+ * \brief Fade over to a track.
+ * \param[in] name File name below the resource base path, like "music/HITLWLTZ.ogg".
+ * \return false if there is no music.
+ * \note Returns at once, the track starts once the decoder thread has opened it.
+ */
+bool music_play(const char *name)
+{
+    if (! music_thread || ! name || ! *name) {
         return false;
     }
-    Mix_PlayMusic(music, -1);
+
+    SDL_LockMutex(music_lock);
+    com_snprintf(music_request.play, sizeof(music_request.play), "%s", name);
+    music_request.stop = false;
+    SDL_UnlockMutex(music_lock);
+
+    SDL_SemPost(music_wake);
+
     return true;
 }
 
-bool music_stop()
+/**
+ * \brief Decode the start of a track ahead of music_play.
+ * \param[in] name File name below the resource base path.
+ */
+void music_prefetch(const char *name)
+{
+    if (! music_thread || ! name || ! *name) {
+        return;
+    }
+
+    SDL_LockMutex(music_lock);
+    com_snprintf(music_request.prefetch, sizeof(music_request.prefetch), "%s", name);
+    SDL_UnlockMutex(music_lock);
+
+    SDL_SemPost(music_wake);
+}
+
+/**
+ * \brief Fade out the playing track, it is closed once silent.
+ */
+bool music_stop(void)
 {
-    music = NULL;
+    if (! music_thread) {
+        return false;
+    }
+
+    SDL_LockMutex(music_lock);
+    music_request.play[ 0 ] = '\0';
+    music_request.stop = true;
+    SDL_UnlockMutex(music_lock);
+
+    SDL_SemPost(music_wake);
+
     return true;
 }
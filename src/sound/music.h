@@ -5,7 +5,34 @@
 #ifndef WOLF3D_REDUX_MUSIC_H
 #define WOLF3D_REDUX_MUSIC_H
 
-bool music_play(char *name);
-bool music_stop();
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+    Music is streamed: a decoder thread reads OGG files in small chunks into
+    one ring buffer per track and the audio callback only copies out of the
+    rings. Opening, decoding and closing files never happen on the main
+    thread, music_play and music_prefetch just leave a request.
+
+    A new track fades in while the old one fades out. A track prefetched
+    during the intermission is already decoded when the next level starts.
+*/
+
+typedef struct {
+    uint32_t decode_usec;   // decoder thread CPU time over the last second
+    uint32_t buffered_msec; // decoded ahead for the playing track
+    uint32_t underruns;     // mixes the decoder fell behind in, since start
+
+} music_stats_t;
+
+extern music_stats_t music_stats;   // for display only
+
+bool music_init(bool null_device);
+void music_shutdown(void);
+void music_mix(int16_t *stream, int frames);
+
+bool music_play(const char *name);
+void music_prefetch(const char *name);
+bool music_stop(void);
 
 #endif //WOLF3D_REDUX_MUSIC_H
@@ -1,20 +1,35 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <SDL2/SDL.h>
 #include <SDL_mixer.h>
 
 #include "sound.h"
+#include "soundfx.h"
+#include "music.h"
 
 bool sound_init()
 {
+    bool null_device = false;
+
     if (SDL_Init(SDL_INIT_AUDIO) != 0) {
         fprintf(stderr, "Unable to initialize SDL: %s\n", SDL_GetError());
         return false;
     }
     if (Mix_OpenAudio( 22050, MIX_DEFAULT_FORMAT, 2, 4096 ) == -1 ) {
-        fprintf(stdout, "Error while initializing sound!\n");
+        // play on without a device, sounds are still mixed into nothing
+        fprintf(stdout, "Error while initializing sound, using the null device!\n");
+        null_device = true;
+    }
+    if (!soundfx_init(null_device)) {
+        fprintf(stdout, "Error while initializing sound effects!\n");
         return false;
     }
+    atexit(soundfx_shutdown);
+    if (!music_init(null_device)) {
+        fprintf(stdout, "Error while initializing music!\n");
+    }
+    atexit(music_shutdown);
     return true;
 }
 
@@ -2,4 +2,530 @@
 // Created by srdja on 7/16/15.
 //
 
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL_mixer.h>
+
 #include "soundfx.h"
+#include "../util/arena.h"
+#include "../util/com_string.h"
+#include "../util/filesystem.h"
+#include "../util/timer.h"
+#include "../game/wolf_math.h"
+
+#define SFX_MAX         256     // distinct sounds
+#define SFX_HASH        512     // power of two, larger than SFX_MAX
+#define SFX_QUEUE       64      // commands, power of two
+#define SFX_MIX_FRAMES  1024    // frames mixed per pass
+#define SFX_NULL_FREQ   22050
+#define SFX_FADE_TILES  32      // ATTN_NORM is silent this far away
+
+struct sfx_s {
+    char name[ 32 ];
+    int16_t *pcm;       // mono at the device rate, NULL if the file is missing
+    uint32_t frames;
+};
+
+typedef enum {
+    SFX_CMD_PLAY,
+    SFX_CMD_STOPALL
+} sfxcmdtype_t;
+
+typedef struct {
+    sfxcmdtype_t type;
+    const sfx_t *sfx;
+    int entnum;
+    int channel;
+    int priority;
+    int left, right;    // volume, 0-256
+} sfxcmd_t;
+
+typedef struct {
+    const sfx_t *sfx;   // NULL if the voice is free
+    uint32_t pos;       // next frame
+    int entnum;
+    int channel;
+    int priority;
+    int left, right;
+} sfxvoice_t;
+
+soundfx_stats_t soundfx_stats;
+
+static sfx_t sfx_known[ SFX_MAX ];
+static int sfx_numknown;
+static int16_t sfx_hash[ SFX_HASH ];    // index + 1 in sfx_known, 0 if empty
+
+// game thread -> mixer
+static sfxcmd_t sfx_queue[ SFX_QUEUE ];
+static SDL_atomic_t sfx_head;   // written by the game thread only
+static SDL_atomic_t sfx_tail;   // written by the mixer only
+
+// mixer only
+static sfxvoice_t sfx_voices[ SFX_VOICES ];
+static int32_t sfx_mixbuf[ SFX_MIX_FRAMES * 2 ];
+
+static int sfx_freq = SFX_NULL_FREQ;
+static int sfx_channels = 2;
+
+// game thread only
+static int32_t sfx_listener_x, sfx_listener_y;
+static int sfx_listener_angle;
+
+static SDL_Thread *sfx_null_thread;
+static SDL_atomic_t sfx_null_quit;
+
+// more important sounds may take the voice of less important ones
+static const int sfx_priority[] = {
+    1,  // CHAN_AUTO
+    3,  // CHAN_WEAPON
+    2,  // CHAN_VOICE
+    2,  // CHAN_ITEM
+    1   // CHAN_BODY
+};
+
+/**
+ * \brief Find a voice for a new sound.
+ * \return NULL if every voice plays something more important.
+ * \note Mixer only.
+ */
+static sfxvoice_t *sfx_pick_voice(const sfxcmd_t *cmd)
+{
+    sfxvoice_t *voice, *best = NULL;
+    int i;
+
+    // same entity and channel: cut the old sound off
+    if (cmd->channel != CHAN_AUTO) {
+        for (i = 0; i < SFX_VOICES; ++i) {
+            voice = &sfx_voices[ i ];
+
+            if (voice->sfx && voice->entnum == cmd->entnum && voice->channel == cmd->channel) {
+                return voice;
+            }
+        }
+    }
+
+    for (i = 0; i < SFX_VOICES; ++i) {
+        if (! sfx_voices[ i ].sfx) {
+            return &sfx_voices[ i ];
+        }
+    }
+
+    // steal the least important voice, of those the one nearest its end
+    for (i = 0; i < SFX_VOICES; ++i) {
+        voice = &sfx_voices[ i ];
+
+        if (! best || voice->priority < best->priority ||
+                (voice->priority == best->priority &&
+                 voice->sfx->frames - voice->pos < best->sfx->frames - best->pos)) {
+            best = voice;
+        }
+    }
+
+    if (best->priority > cmd->priority) {
+        return NULL;
+    }
+
+    soundfx_stats.stolen++;
+
+    return best;
+}
+
+/**
+ * \brief Take the commands the game thread queued since the last mix.
+ * \note Mixer only.
+ */
+static void sfx_run_commands(void)
+{
+    int tail = SDL_AtomicGet(&sfx_tail);
+    int head = SDL_AtomicGet(&sfx_head);
+    const sfxcmd_t *cmd;
+    sfxvoice_t *voice;
+
+    for ( ; tail != head; ++tail) {
+        cmd = &sfx_queue[ tail & (SFX_QUEUE - 1) ];
+
+        switch (cmd->type) {
+        case SFX_CMD_PLAY:
+            voice = sfx_pick_voice(cmd);
+
+            if (! voice) {
+                soundfx_stats.dropped++;
+                break;
+            }
+
+            voice->sfx = cmd->sfx;
+            voice->pos = 0;
+            voice->entnum = cmd->entnum;
+            voice->channel = cmd->channel;
+            voice->priority = cmd->priority;
+            voice->left = cmd->left;
+            voice->right = cmd->right;
+            break;
+
+        case SFX_CMD_STOPALL:
+            memset(sfx_voices, 0, sizeof(sfx_voices));
+            break;
+        }
+    }
+
+    SDL_AtomicSet(&sfx_tail, tail);   // hands the slots back
+}
+
+/**
+ * \brief Queue a command for the mixer.
+ * \return false if the queue is full.
+ * \note Game thread only.
+ */
+static bool sfx_push(const sfxcmd_t *cmd)
+{
+    int head = SDL_AtomicGet(&sfx_head);
+
+    if (head - SDL_AtomicGet(&sfx_tail) >= SFX_QUEUE) {
+        soundfx_stats.dropped++;
+        return false;
+    }
+
+    sfx_queue[ head & (SFX_QUEUE - 1) ] = *cmd;
+    SDL_AtomicSet(&sfx_head, head + 1);   // full barrier, the command is written before it is seen
+
+    return true;
+}
+
+/**
+ * \brief Add the playing voices to a stream.
+ * \param[in,out] stream Signed 16 bit samples at the device rate and channel count.
+ * \param[in] frames Frames in stream.
+ * \note Called by the audio device, or the null device without one.
+ */
+void soundfx_mix(int16_t *stream, int frames)
+{
+    uint64_t start = Sys_Microseconds();
+    sfxvoice_t *voice;
+    const int16_t *src;
+    int32_t *dst, s;
+    int i, v, n, count, active = 0;
+
+    sfx_run_commands();
+
+    while (frames > 0) {
+        count = frames < SFX_MIX_FRAMES ? frames : SFX_MIX_FRAMES;
+        n = count * sfx_channels;
+
+        for (i = 0; i < n; ++i) {
+            sfx_mixbuf[ i ] = stream[ i ];
+        }
+
+        for (v = 0; v < SFX_VOICES; ++v) {
+            voice = &sfx_voices[ v ];
+
+            if (! voice->sfx) {
+                continue;
+            }
+
+            n = voice->sfx->frames - voice->pos;
+            n = n < count ? n : count;
+            src = voice->sfx->pcm + voice->pos;
+            dst = sfx_mixbuf;
+
+            if (sfx_channels == 2) {
+                for (i = 0; i < n; ++i) {
+                    *dst++ += (src[ i ] * voice->left) >> 8;
+                    *dst++ += (src[ i ] * voice->right) >> 8;
+                }
+            } else {
+                s = (voice->left + voice->right) >> 1;
+
+                for (i = 0; i < n; ++i) {
+                    *dst++ += (src[ i ] * s) >> 8;
+                }
+            }
+
+            voice->pos += n;
+
+            if (voice->pos >= voice->sfx->frames) {
+                voice->sfx = NULL;
+            }
+        }
+
+        n = count * sfx_channels;
+
+        for (i = 0; i < n; ++i) {
+            s = sfx_mixbuf[ i ];
+            stream[ i ] = s > 32767 ? 32767 : s < -32768 ? -32768 : (int16_t) s;
+        }
+
+        stream += n;
+        frames -= count;
+    }
+
+    for (v = 0; v < SFX_VOICES; ++v) {
+        active += sfx_voices[ v ].sfx != NULL;
+    }
+
+    soundfx_stats.voices = active;
+    soundfx_stats.mix_usec = (uint32_t) (Sys_Microseconds() - start);
+}
+
+/**
+ * \brief SDL_mixer post-mix callback, runs on the audio thread.
+ */
+static void sfx_postmix(void *udata, Uint8 *stream, int len)
+{
+    (void) udata;
+
+    soundfx_mix((int16_t *) stream, len / (sfx_channels * (int) sizeof(int16_t)));
+}
+
+/**
+ * \brief Null device: mix into nothing at the pace of a real one.
+ */
+static int sfx_null_device(void *unused)
+{
+    static int16_t silence[ SFX_MIX_FRAMES * 2 ];
+
+    (void) unused;
+
+    while (! SDL_AtomicGet(&sfx_null_quit)) {
+        memset(silence, 0, sizeof(silence));
+        soundfx_mix(silence, SFX_MIX_FRAMES);
+        SDL_Delay(SFX_MIX_FRAMES * 1000 / sfx_freq);
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Start mixing sound effects.
+ * \param[in] null_device true if there is no audio device, otherwise SDL_mixer must be open.
+ * \return false on error.
+ * \note Falls back to the null device if the audio format isn't signed 16 bit.
+ */
+bool soundfx_init(bool null_device)
+{
+    Uint16 format;
+
+    if (! null_device && Mix_QuerySpec(&sfx_freq, &format, &sfx_channels)) {
+        if (format == AUDIO_S16SYS && (sfx_channels == 1 || sfx_channels == 2)) {
+            Mix_SetPostMix(sfx_postmix, NULL);
+            return true;
+        }
+
+        printf("[soundfx_init]: unsupported audio format, sound effects are muted\n");
+    }
+
+    sfx_freq = SFX_NULL_FREQ;
+    sfx_channels = 2;
+
+    SDL_AtomicSet(&sfx_null_quit, 0);
+    sfx_null_thread = SDL_CreateThread(sfx_null_device, "soundfx", NULL);
+
+    return sfx_null_thread != NULL;
+}
+
+/**
+ * \brief Stop mixing sound effects.
+ */
+void soundfx_shutdown(void)
+{
+    if (sfx_null_thread) {
+        SDL_AtomicSet(&sfx_null_quit, 1);
+        SDL_WaitThread(sfx_null_thread, NULL);
+        sfx_null_thread = NULL;
+    } else {
+        Mix_SetPostMix(NULL, NULL);
+    }
+}
+
+/**
+ * \brief Hash slot of a sound name.
+ */
+static int sfx_find(const char *name)
+{
+    uint32_t h = 2166136261u;
+    const char *c;
+    int slot;
+
+    for (c = name; *c; ++c) {
+        h = (h ^ (uint8_t) *c) * 16777619u;
+    }
+
+    for (slot = h & (SFX_HASH - 1); sfx_hash[ slot ]; slot = (slot + 1) & (SFX_HASH - 1)) {
+        if (! strcmp(sfx_known[ sfx_hash[ slot ] - 1 ].name, name)) {
+            break;
+        }
+    }
+
+    return slot;
+}
+
+/**
+ * \brief Decode a wave file to mono PCM at the device rate.
+ * \param[in,out] sfx Sound, with its name set.
+ */
+static void sfx_load(sfx_t *sfx)
+{
+    char path[ MAX_OSPATH ];
+    SDL_AudioSpec spec;
+    SDL_AudioCVT cvt;
+    Uint8 *wav;
+    Uint32 len;
+
+    com_snprintf(path, sizeof(path), "%s/%s", get_resource_base_path(), sfx->name);
+
+    if (! SDL_LoadWAV(path, &spec, &wav, &len)) {
+        return;
+    }
+
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, AUDIO_S16SYS, 1, sfx_freq) < 0) {
+        printf("[sfx_load]: can't convert %s\n", sfx->name);
+        SDL_FreeWAV(wav);
+        return;
+    }
+
+    cvt.len = len;
+    cvt.buf = Mem_Alloc(len * cvt.len_mult);
+
+    if (cvt.buf) {
+        memcpy(cvt.buf, wav, len);
+
+        if (SDL_ConvertAudio(&cvt) == 0) {
+            sfx->pcm = (int16_t *) cvt.buf;
+            sfx->frames = cvt.len_cvt / sizeof(int16_t);
+
+            soundfx_stats.sounds++;
+            soundfx_stats.pcm_bytes += cvt.len_cvt;
+        } else {
+            Mem_Free(cvt.buf);
+        }
+    }
+
+    SDL_FreeWAV(wav);
+}
+
+/**
+ * \brief Find a sound, decoding it if it is new.
+ * \param[in] name File name below the resource base path, like "sfx/001.wav".
+ * \return NULL if the file is missing or there are too many sounds.
+ * \note Sounds from Sound_Precache are only looked up, nothing is read or allocated.
+ */
+sfx_t *Sound_RegisterSound(const char *name)
+{
+    int slot = sfx_find(name);
+    sfx_t *sfx;
+
+    if (! sfx_hash[ slot ]) {
+        if (sfx_numknown == SFX_MAX || strlen(name) >= sizeof(sfx->name)) {
+            return NULL;
+        }
+
+        sfx = &sfx_known[ sfx_numknown++ ];
+        strcpy(sfx->name, name);
+        sfx_load(sfx);
+
+        sfx_hash[ slot ] = (int16_t) sfx_numknown;
+    }
+
+    sfx = &sfx_known[ sfx_hash[ slot ] - 1 ];
+
+    return sfx->pcm ? sfx : NULL;
+}
+
+/**
+ * \brief Decode numbered sounds ahead of play.
+ * \param[in] dir Directory below the resource base path.
+ * \param[in] count Sounds dir/000.wav up to dir/count-1.wav.
+ * \note Sounds stay decoded for good, later calls only look them up.
+ */
+void Sound_Precache(const char *dir, int count)
+{
+    char name[ 32 ];
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        com_snprintf(name, sizeof(name), "%s/%03d.wav", dir, i);
+        Sound_RegisterSound(name);
+    }
+}
+
+/**
+ * \brief Set where sounds are heard from.
+ * \param[in] x X position in global units.
+ * \param[in] y Y position in global units.
+ * \param[in] angle FINE angle the listener faces.
+ * \note Call every tic before the game plays sounds.
+ */
+void Sound_SetListener(int32_t x, int32_t y, int angle)
+{
+    sfx_listener_x = x;
+    sfx_listener_y = y;
+    sfx_listener_angle = angle;
+}
+
+/**
+ * \brief Play a sound.
+ * \param[in] origin X and Y in global units, NULL for the listener.
+ * \param[in] entnum Entity playing the sound.
+ * \param[in] entchannel CHAN_AUTO or a channel of entnum, cutting off what it plays.
+ * \param[in] sfx Sound from Sound_RegisterSound, NULL plays nothing.
+ * \param[in] fvol Volume, 0.0 to 1.0.
+ * \param[in] attenuation How fast the sound fades with distance, ATTN_NONE to ATTN_STATIC.
+ * \param[in] timeofs Unused.
+ * \note Gain and pan are worked out once, here. A sound too far away to hear never reaches the mixer.
+ */
+void Sound_StartSound(const int32_t *origin, int entnum, int entchannel, sfx_t *sfx, float fvol, float attenuation, float timeofs)
+{
+    sfxcmd_t cmd;
+    int32_t dx, dy, dist;
+    int volume = (int) (fvol * 256);
+    int gain, pan;
+
+    (void) timeofs;
+
+    if (! sfx) {
+        return;
+    }
+
+    cmd.left = cmd.right = volume;
+
+    if (origin) {
+        dx = origin[ 0 ] - sfx_listener_x;
+        dy = origin[ 1 ] - sfx_listener_y;
+
+        // octagonal distance in 1/256 tiles, within 12% of the real one
+        dist = ABS(dx) > ABS(dy) ? (ABS(dx) + (ABS(dy) >> 1)) >> 8 : (ABS(dy) + (ABS(dx) >> 1)) >> 8;
+        gain = 256 - dist * (int) attenuation / SFX_FADE_TILES;
+
+        if (gain <= 0) {
+            soundfx_stats.culled++;
+            return;
+        }
+
+        // positive to the left, angles grow counter-clockwise
+        pan = (dx || dy) ? FixedSin(FineNormalize(FineAtan2(dy, dx) - sfx_listener_angle)) >> 9 : 0;
+
+        cmd.left = (volume * gain * (256 + pan)) >> 16;
+        cmd.right = (volume * gain * (256 - pan)) >> 16;
+    }
+
+    cmd.type = SFX_CMD_PLAY;
+    cmd.sfx = sfx;
+    cmd.entnum = entnum;
+    cmd.channel = entchannel;
+    cmd.priority = sfx_priority[ entchannel >= 0 && entchannel <= CHAN_BODY ? entchannel : CHAN_AUTO ];
+
+    sfx_push(&cmd);
+}
+
+/**
+ * \brief Silence every sound effect.
+ */
+void Sound_StopAllSounds(void)
+{
+    sfxcmd_t cmd;
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = SFX_CMD_STOPALL;
+
+    sfx_push(&cmd);
+}
@@ -6,7 +6,60 @@
 #define WOLF3D_REDUX_SOUNDFX_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
-bool soundfx_play(char *sound);
+/*
+    Sound effects are decoded to PCM once by Sound_Precache and mixed on
+    top of the music by a SDL_mixer post-mix callback. The game thread
+    only hands commands to the mixer through a single producer, single
+    consumer queue: no locks and no allocation while playing.
+
+    Without an audio device a null device mixes into nothing on its own
+    thread, so the engine can be run and measured headless.
+
+    Sounds with an origin get their gain and stereo pan from where the
+    listener stands and faces when they start. The game leaves out sounds
+    from areas not connected to the player's, see areabyplayer.
+*/
+
+// entity channels, a sound replaces the one on the same entity and channel
+#define CHAN_AUTO   0   // never replaces
+#define CHAN_WEAPON 1
+#define CHAN_VOICE  2
+#define CHAN_ITEM   3
+#define CHAN_BODY   4
+
+// attenuation
+#define ATTN_NONE   0   // full volume everywhere
+#define ATTN_NORM   1
+#define ATTN_IDLE   2
+#define ATTN_STATIC 3   // diminish very rapidly with distance
+
+#define SFX_VOICES  16
+
+typedef struct sfx_s sfx_t;
+
+typedef struct {
+    uint32_t sounds;    // decoded sounds
+    uint32_t pcm_bytes; // used by them
+    uint32_t voices;    // playing at the last mix
+    uint32_t stolen;    // voices taken from a less important sound, since start
+    uint32_t dropped;   // sounds not played: queue full or nothing to steal, since start
+    uint32_t culled;    // sounds not played: out of earshot, since start
+    uint32_t mix_usec;  // last mix
+
+} soundfx_stats_t;
+
+extern soundfx_stats_t soundfx_stats;   // for display only
+
+bool soundfx_init(bool null_device);
+void soundfx_shutdown(void);
+void soundfx_mix(int16_t *stream, int frames);
+
+void Sound_Precache(const char *dir, int count);
+sfx_t *Sound_RegisterSound(const char *name);
+void Sound_SetListener(int32_t x, int32_t y, int angle);
+void Sound_StartSound(const int32_t *origin, int entnum, int entchannel, sfx_t *sfx, float fvol, float attenuation, float timeofs);
+void Sound_StopAllSounds(void);
 
 #endif //WOLF3D_REDUX_SOUNDFX_H
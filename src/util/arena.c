@@ -0,0 +1,137 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file arena.c
+ * \brief Level and frame memory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGN 8
+
+static uint64_t level_mem[ LEVEL_ARENA_SIZE / sizeof (uint64_t) ];
+static uint64_t frame_mem[ FRAME_ARENA_SIZE / sizeof (uint64_t) ];
+
+arena_t level_arena = { (uint8_t *)level_mem, sizeof (level_mem), 0, 0, "level" };
+arena_t frame_arena = { (uint8_t *)frame_mem, sizeof (frame_mem), 0, 0, "frame" };
+
+mem_stats_t mem_stats;
+
+static uint32_t frame_peak;
+static uint32_t heap_allocs;
+
+/**
+ * \brief Allocate from an arena.
+ * \param[in] arena Arena to allocate from.
+ * \param[in] size Bytes wanted.
+ * \return NULL if the arena is full, otherwise 8 byte aligned memory.
+ * \note The memory is not cleared. There is no free, see Arena_Release and Arena_Reset.
+ */
+void *Arena_Alloc (arena_t *arena, size_t size)
+{
+    void *ptr;
+
+    size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+    if (size > arena->size - arena->used) {
+        printf ("[Arena_Alloc]: %s arena out of memory (%lu of %lu bytes used, %lu wanted)\n",
+                arena->name, (unsigned long)arena->used, (unsigned long)arena->size, (unsigned long)size);
+        return NULL;
+    }
+
+    ptr = arena->base + arena->used;
+    arena->used += size;
+    arena->allocs++;
+
+    if (arena == &frame_arena && arena->used > frame_peak) {
+        frame_peak = (uint32_t)arena->used;
+    }
+
+    return ptr;
+}
+
+/**
+ * \brief Remember how much of an arena is used.
+ * \return Mark to pass to Arena_Release.
+ */
+size_t Arena_Mark (arena_t *arena)
+{
+    return arena->used;
+}
+
+/**
+ * \brief Give back everything allocated since a mark.
+ * \param[in] arena Arena
+ * \param[in] mark Value returned by Arena_Mark.
+ */
+void Arena_Release (arena_t *arena, size_t mark)
+{
+    if (mark < arena->used) {
+        arena->used = mark;
+    }
+}
+
+/**
+ * \brief Give back everything.
+ * \param[in] arena Arena
+ */
+void Arena_Reset (arena_t *arena)
+{
+    arena->used = 0;
+    arena->allocs = 0;
+}
+
+/**
+ * \brief Start a new frame: latch last frame's counters and reset the frame arena.
+ */
+void Mem_BeginFrame (void)
+{
+    mem_stats.frame_allocs = frame_arena.allocs;
+    mem_stats.frame_bytes = frame_peak;
+    mem_stats.heap_allocs = heap_allocs;
+
+    heap_allocs = 0;
+    frame_peak = 0;
+    Arena_Reset (&frame_arena);
+}
+
+/**
+ * \brief Allocate zeroed memory from the heap.
+ * \param[in] size Bytes wanted.
+ * \return NULL on error, otherwise pointer to memory. Free with Mem_Free.
+ * \note Only for memory that outlives a level; counted for the statistics overlay.
+ */
+void *Mem_Alloc (size_t size)
+{
+    heap_allocs++;
+    mem_stats.heap_total++;
+
+    return calloc (1, size);
+}
+
+/**
+ * \brief Free memory from Mem_Alloc.
+ */
+void Mem_Free (void *ptr)
+{
+    free (ptr);
+}
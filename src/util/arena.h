@@ -0,0 +1,75 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+ *  arena.h:   Level and frame memory.
+ *
+ */
+
+/*
+    Notes:
+    This module is implemented by arena.c
+
+    Two fixed arenas instead of malloc / free pairs. level_arena holds what
+    lives as long as the current map and is reset by R_BeginRegistration,
+    frame_arena holds scratch and is reset at the start of every frame.
+    Longer lived heap memory goes through Mem_Alloc so it can be counted.
+
+*/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LEVEL_ARENA_SIZE    (256 * 1024)
+#define FRAME_ARENA_SIZE    (256 * 1024)
+
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    uint32_t allocs;    // since the last reset
+    const char *name;
+
+} arena_t;
+
+typedef struct {
+    uint32_t frame_allocs;  // frame arena, last frame
+    uint32_t frame_bytes;   // frame arena high water mark, last frame
+    uint32_t heap_allocs;   // Mem_Alloc, last frame
+    uint32_t heap_total;    // Mem_Alloc since start
+
+} mem_stats_t;
+
+extern arena_t level_arena;
+extern arena_t frame_arena;
+extern mem_stats_t mem_stats;
+
+void *Arena_Alloc (arena_t *arena, size_t size);
+size_t Arena_Mark (arena_t *arena);
+void Arena_Release (arena_t *arena, size_t mark);
+void Arena_Reset (arena_t *arena);
+
+void Mem_BeginFrame (void);
+void *Mem_Alloc (size_t size);
+void Mem_Free (void *ptr);
+
+
+#endif /* __ARENA_H__ */
@@ -31,6 +31,7 @@
 
 #include "../common.h"
 #include "com_string.h"
+#include "arena.h"
 
 /**
  * \brief Get the length of a file.
@@ -133,7 +134,7 @@ void FS_CloseFile (filehandle_t *fhandle)
         free (fhandle->filedata);
     }
 
-    free (fhandle);
+    Mem_Free (fhandle);
 }
 
 /**
@@ -151,8 +152,11 @@ filehandle_t *FS_OpenFile (const char *filename)
     char            netpath[ MAX_OSPATH ];
     filehandle_t    *hFile;
 
-    hFile = (filehandle_t *)malloc (sizeof (filehandle_t));
-    memset (hFile, 0, sizeof (filehandle_t));
+    hFile = (filehandle_t *)Mem_Alloc (sizeof (filehandle_t));
+
+    if (! hFile) {
+        return NULL;
+    }
 
     com_snprintf(netpath, sizeof (netpath), "%s/%s", get_resource_base_path(), filename);
 
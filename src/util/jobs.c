@@ -0,0 +1,184 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/**
+ * \file jobs.c
+ * \brief Worker threads.
+ */
+
+#include <SDL2/SDL.h>
+
+#include "jobs.h"
+
+static SDL_Thread *job_threads[ JOBS_MAX_THREADS ];
+static int job_numthreads;
+
+static SDL_sem *job_start;  // one post per worker per job
+static SDL_sem *job_done;   // one post per worker when it ran out of indices
+static SDL_atomic_t job_quit;
+
+// current job, written before job_start is posted
+static SDL_atomic_t job_next;
+static int job_count;
+static jobfunc_t job_func;
+static void *job_data;
+
+/**
+ * \brief Run indices of the current job until none are left.
+ */
+static void Jobs_Drain (void)
+{
+    int i, end;
+
+    while ((i = SDL_AtomicAdd (&job_next, JOBS_BATCH)) < job_count) {
+        end = i + JOBS_BATCH < job_count ? i + JOBS_BATCH : job_count;
+
+        for ( ; i < end ; ++i) {
+            job_func (i, job_data);
+        }
+    }
+}
+
+/**
+ * \brief Worker thread.
+ */
+static int Jobs_Worker (void *unused)
+{
+    (void) unused;
+
+    for ( ; ; ) {
+        SDL_SemWait (job_start);
+
+        if (SDL_AtomicGet (&job_quit)) {
+            return 0;
+        }
+
+        Jobs_Drain ();
+        SDL_SemPost (job_done);
+    }
+}
+
+/**
+ * \brief Start the worker threads.
+ * \param[in] numthreads Threads besides the calling one, 0 runs every job serially.
+ * \note Falls back to serial if the threads can't be created.
+ */
+void Jobs_Init (int numthreads)
+{
+    Jobs_Shutdown ();
+
+    if (numthreads > JOBS_MAX_THREADS) {
+        numthreads = JOBS_MAX_THREADS;
+    }
+
+    if (numthreads <= 0) {
+        return;
+    }
+
+    job_start = SDL_CreateSemaphore (0);
+    job_done = SDL_CreateSemaphore (0);
+
+    if (! job_start || ! job_done) {
+        Jobs_Shutdown ();
+        return;
+    }
+
+    SDL_AtomicSet (&job_quit, 0);
+
+    for (job_numthreads = 0 ; job_numthreads < numthreads ; ++job_numthreads) {
+        job_threads[ job_numthreads ] = SDL_CreateThread (Jobs_Worker, "jobs", NULL);
+
+        if (! job_threads[ job_numthreads ]) {
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Stop the worker threads.
+ */
+void Jobs_Shutdown (void)
+{
+    int i;
+
+    SDL_AtomicSet (&job_quit, 1);
+
+    for (i = 0 ; i < job_numthreads ; ++i) {
+        SDL_SemPost (job_start);
+    }
+
+    for (i = 0 ; i < job_numthreads ; ++i) {
+        SDL_WaitThread (job_threads[ i ], NULL);
+        job_threads[ i ] = NULL;
+    }
+
+    job_numthreads = 0;
+
+    if (job_start) {
+        SDL_DestroySemaphore (job_start);
+        job_start = NULL;
+    }
+
+    if (job_done) {
+        SDL_DestroySemaphore (job_done);
+        job_done = NULL;
+    }
+}
+
+/**
+ * \brief Number of worker threads running.
+ */
+int Jobs_NumThreads (void)
+{
+    return job_numthreads;
+}
+
+/**
+ * \brief Call func for every index in [0, count) on all threads.
+ * \param[in] count Number of indices.
+ * \param[in] func Called once per index, in no particular order.
+ * \param[in] data Passed to func.
+ * \note Returns after every call finished.
+ */
+void Jobs_ParallelFor (int count, jobfunc_t func, void *data)
+{
+    int i;
+
+    if (job_numthreads == 0 || count <= JOBS_BATCH) {
+        for (i = 0 ; i < count ; ++i) {
+            func (i, data);
+        }
+
+        return;
+    }
+
+    job_count = count;
+    job_func = func;
+    job_data = data;
+    SDL_AtomicSet (&job_next, 0);
+
+    for (i = 0 ; i < job_numthreads ; ++i) {
+        SDL_SemPost (job_start);
+    }
+
+    Jobs_Drain ();
+
+    for (i = 0 ; i < job_numthreads ; ++i) {
+        SDL_SemWait (job_done);
+    }
+}
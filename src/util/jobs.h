@@ -0,0 +1,46 @@
+/*
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+/*
+ *  jobs.h:   Worker threads.
+ *
+ */
+
+/*
+    Notes:
+    Jobs_ParallelFor blocks until every index was handed to func exactly
+    once. The calling thread works along, so with no workers it is a plain
+    loop. func must only write to memory owned by its index.
+
+*/
+
+#ifndef __JOBS_H__
+#define __JOBS_H__
+
+#define JOBS_MAX_THREADS    8
+#define JOBS_BATCH          8   // indices taken per grab of the shared counter, fewer run on the caller
+
+typedef void (*jobfunc_t) (int index, void *data);
+
+void Jobs_Init (int numthreads);
+void Jobs_Shutdown (void);
+int Jobs_NumThreads (void);
+void Jobs_ParallelFor (int count, jobfunc_t func, void *data);
+
+
+#endif /* __JOBS_H__ */
@@ -36,6 +36,7 @@
 #define __TIMER_H__
 
 uint32_t Sys_Milliseconds (void);
+uint64_t Sys_Microseconds (void);
 
 
 #endif /* __TIMER_H__ */
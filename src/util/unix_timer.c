@@ -54,3 +54,16 @@ uint32_t Sys_Milliseconds (void)
 
     return curtime;
 }
+
+/**
+ * \brief This function retrieves the system time, in microseconds.
+ * \return Returns the system time, in microseconds. Only differences between two calls are meaningful.
+ */
+uint64_t Sys_Microseconds (void)
+{
+    struct timeval tp;
+
+    gettimeofday (&tp, NULL);
+
+    return (uint64_t)tp.tv_sec * 1000000 + tp.tv_usec;
+}